@@ -0,0 +1,773 @@
+/*
+ * Benchmark of gui hot paths
+ *
+ * Usage: ./benchmark [--software] [font]
+ *
+ * The benchmarks run on the null backend, or on the software backend,
+ * and the results are printed to stdout as JSON
+ */
+
+#define GUI_IMPLEMENT
+#include "gui.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+
+#define LAYOUT_COUNT    1000000
+#define TEXT_DRAW_COUNT 10000
+#define HIT_TEST_COUNT  100000
+#define TRIGGER_COUNT   100000
+#define FRAME_COUNT     100
+
+#define TEXTURE_MAX_COUNT 1000
+
+#define LOAD_COUNT     64
+#define LOAD_SIZE      256
+#define LOAD_MAX_RUNS  8
+
+#define ICON_COUNT     256
+#define ICON_SIZE      32
+
+/*
+ * Get current time in microseconds
+ */
+static double time_us_get(void)
+{
+  return (double) SDL_GetPerformanceCounter() * 1000000.0 / (double) SDL_GetPerformanceFrequency();
+}
+
+static bool is_first_result = true;
+
+/*
+ * Print one result as a JSON object
+ */
+static void result_print(const char* name, size_t count, double us)
+{
+  printf("%s\n    { \"name\": \"%s\", \"count\": %zu, \"us_per_op\": %.3f }", is_first_result ? "" : ",", name, count, us);
+
+  is_first_result = false;
+}
+
+/*
+ * Print one result with the number of draw calls as a JSON object
+ */
+static void result_draw_print(const char* name, size_t count, double us, size_t draw_call_count)
+{
+  printf("%s\n    { \"name\": \"%s\", \"count\": %zu, \"us_per_op\": %.3f, \"draw_calls\": %zu }", is_first_result ? "" : ",", name, count, us, draw_call_count);
+
+  is_first_result = false;
+}
+
+/*
+ * Create menu with count windows, laid out in a square grid
+ */
+static gui_menu_t* bench_menu_create(gui_t* gui, size_t count)
+{
+  gui_menu_t* menu = gui_menu_create(gui, "bench");
+
+  if (!menu) return NULL;
+
+  gui_active_menu_set(gui, "bench");
+
+  int side = 1;
+
+  while ((size_t) (side * side) < count)
+  {
+    side++;
+  }
+
+  int window_w = MAX(1, gui->width  / side);
+  int window_h = MAX(1, gui->height / side);
+
+  for (size_t index = 0; index < count; index++)
+  {
+    int col = index % side;
+    int row = index / side;
+
+    gui_window_t* window = gui_menu_window_create(menu, "window",
+      (gui_rect_t) {
+        .width  = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = window_w },
+        .height = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = window_h },
+        .left   = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = col * window_w },
+        .top    = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = row * window_h },
+        .xpos   = GUI_POS_LEFT,
+        .ypos   = GUI_POS_TOP
+      },
+      (gui_border_t) { 0 }
+    );
+
+    if (!window)
+    {
+      gui_menu_destroy(gui, "bench");
+
+      return NULL;
+    }
+  }
+
+  return menu;
+}
+
+/*
+ * Layout rects of different kinds with sdl_rect_create
+ */
+static void layout_bench(void)
+{
+  gui_rect_t rects[] =
+  {
+    {
+      .width  = (gui_size_t) { .type = GUI_SIZE_MAX },
+      .height = (gui_size_t) { .type = GUI_SIZE_MAX }
+    },
+    {
+      .width  = (gui_size_t) { .type = GUI_SIZE_REL, .value.rel = 0.5 },
+      .height = (gui_size_t) { .type = GUI_SIZE_REL, .value.rel = 0.4 },
+      .xpos   = GUI_POS_RIGHT,
+      .ypos   = GUI_POS_CENTER
+    },
+    {
+      .width  = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = 100 },
+      .height = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = 100 },
+      .top    = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = 10 },
+      .left   = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = 10 },
+      .xpos   = GUI_POS_LEFT,
+      .ypos   = GUI_POS_TOP
+    },
+    {
+      .height       = (gui_size_t) { .type = GUI_SIZE_MAX },
+      .aspect_ratio = 1.5
+    }
+  };
+
+  size_t rect_count = sizeof(rects) / sizeof(gui_rect_t);
+
+  volatile int sink = 0;
+
+  double start = time_us_get();
+
+  for (int index = 0; index < LAYOUT_COUNT; index++)
+  {
+    SDL_Rect rect = sdl_rect_create(rects[index % rect_count], 800 + (index & 7), 600);
+
+    sink += rect.x + rect.w;
+  }
+
+  result_print("layout", rect_count, (time_us_get() - start) / LAYOUT_COUNT);
+}
+
+/*
+ * Render count textures by name into a window with gui_texture_render
+ */
+static void texture_render_bench(gui_t* gui, size_t count)
+{
+  static char names[TEXTURE_MAX_COUNT][32];
+
+  // The textures are kept in the assets, from one run to the next
+  for (size_t index = gui->assets->texture_count; index < count; index++)
+  {
+    snprintf(names[index], sizeof(names[index]), "texture-%zu", index);
+
+    SDL_Texture* texture = sdl_texture_create(gui->renderer, 32, 32);
+
+    gui_texture_t* gui_texture = texture ? gui_texture_create(names[index], texture) : NULL;
+
+    if (!gui_texture || gui_assets_texture_add(gui->assets, gui_texture) != 0)
+    {
+      fprintf(stderr, "Failed to create texture: %s\n", names[index]);
+
+      return;
+    }
+  }
+
+  if (!bench_menu_create(gui, 1)) return;
+
+  gui_rect_t rect =
+  {
+    .width  = (gui_size_t) { .type = GUI_SIZE_MAX },
+    .height = (gui_size_t) { .type = GUI_SIZE_MAX }
+  };
+
+  int draw_count = 0;
+
+  double start = time_us_get();
+
+  while (draw_count < TEXT_DRAW_COUNT)
+  {
+    for (size_t index = 0; index < count; index++, draw_count++)
+    {
+      gui_texture_render(gui, "bench", (char*[]) { "window", NULL }, names[index], rect);
+    }
+  }
+
+  result_print("texture-render", count, (time_us_get() - start) / draw_count);
+
+  gui_menu_destroy(gui, "bench");
+}
+
+/*
+ * Render dynamic strings the old way,
+ * by creating and destroying a texture per string
+ */
+static double text_create_bench(gui_t* gui, gui_font_t* font, SDL_Texture* target)
+{
+  char string[64];
+
+  SDL_Color color = { 0, 255, 0, 255 };
+
+  double start = time_us_get();
+
+  for (int index = 0; index < TEXT_DRAW_COUNT; index++)
+  {
+    snprintf(string, sizeof(string), "Score: %d", index);
+
+    SDL_Texture* texture = sdl_text_texture_create(gui->renderer, string, font->font, color);
+
+    SDL_Rect rect = { 0, 0, 200, 50 };
+
+    gui_target_texture_render(gui, target, texture, &rect);
+
+    sdl_texture_destroy(&texture);
+  }
+
+  gui_target_set(gui, NULL);
+
+  SDL_RenderPresent(gui->renderer);
+
+  return (time_us_get() - start) / TEXT_DRAW_COUNT;
+}
+
+/*
+ * Render dynamic strings with the glyph atlas
+ */
+static double text_atlas_bench(gui_t* gui, gui_font_t* font, SDL_Texture* target)
+{
+  char string[64];
+
+  gui_color_t color = { 0, 255, 0, 255 };
+
+  gui_glyph_atlas_t* atlas = gui_font_atlas_get(gui, font);
+
+  if (!atlas) return -1;
+
+  double start = time_us_get();
+
+  for (int index = 0; index < TEXT_DRAW_COUNT; index++)
+  {
+    snprintf(string, sizeof(string), "Score: %d", index);
+
+    gui_glyph_atlas_text_load(atlas, gui->renderer, font->font, string);
+
+    SDL_Rect rect = { 0, 0, 200, 50 };
+
+    gui_glyph_atlas_text_render(atlas, gui, target, string, color, rect);
+  }
+
+  gui_target_set(gui, NULL);
+
+  SDL_RenderPresent(gui->renderer);
+
+  return (time_us_get() - start) / TEXT_DRAW_COUNT;
+}
+
+/*
+ * Render dynamic strings into a window with gui_text_render
+ */
+static double text_render_bench(gui_t* gui)
+{
+  if (!bench_menu_create(gui, 1)) return -1;
+
+  char string[64];
+
+  gui_rect_t rect =
+  {
+    .width  = (gui_size_t) { .type = GUI_SIZE_MAX },
+    .height = (gui_size_t) { .type = GUI_SIZE_NONE }
+  };
+
+  double start = time_us_get();
+
+  for (int index = 0; index < TEXT_DRAW_COUNT; index++)
+  {
+    snprintf(string, sizeof(string), "Score: %d", index);
+
+    gui_text_render(gui, "bench", (char*[]) { "window", NULL },
+      (gui_text_t) { string, "default", (gui_color_t) { 0, 255, 0, 255 } }, rect);
+  }
+
+  double us = (time_us_get() - start) / TEXT_DRAW_COUNT;
+
+  gui_menu_destroy(gui, "bench");
+
+  return us;
+}
+
+/*
+ * Compare text rendering paths
+ */
+static void text_bench(gui_t* gui, char* font_path)
+{
+  if (gui_fonts_load(gui, (gui_asset_t[]) { { "default", font_path } }, 1) != 0)
+  {
+    fprintf(stderr, "Failed to load font, skipping text benchmarks: %s\n", font_path);
+
+    return;
+  }
+
+  gui_font_t* font = gui_font_get(gui, "default");
+
+  SDL_Texture* target = gui_target_texture_create(gui, gui->width, gui->height);
+
+  if (!font || !target) return;
+
+  result_print("text-create", 1, text_create_bench(gui, font, target));
+
+  result_print("text-atlas", 1, text_atlas_bench(gui, font, target));
+
+  result_print("text-render", 1, text_render_bench(gui));
+
+  gui_target_forget(gui, target);
+
+  sdl_texture_destroy(&target);
+}
+
+/*
+ * Create a board window filled with side * side child cells
+ */
+static gui_window_t* board_create(gui_t* gui, gui_menu_t* menu, int side)
+{
+  gui_window_t* board = gui_menu_window_create(menu, "board",
+    (gui_rect_t) {
+      .width  = (gui_size_t) { .type = GUI_SIZE_MAX },
+      .height = (gui_size_t) { .type = GUI_SIZE_MAX }
+    },
+    (gui_border_t) { 0 }
+  );
+
+  if (!board) return NULL;
+
+  int cell_w = MAX(1, gui->width  / side);
+  int cell_h = MAX(1, gui->height / side);
+
+  for (int row = 0; row < side; row++)
+  {
+    for (int col = 0; col < side; col++)
+    {
+      gui_window_child_create(board, "cell",
+        (gui_rect_t) {
+          .width  = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = cell_w },
+          .height = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = cell_h },
+          .left   = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = col * cell_w },
+          .top    = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = row * cell_h },
+          .xpos   = GUI_POS_LEFT,
+          .ypos   = GUI_POS_TOP
+        }
+      );
+    }
+  }
+
+  return board;
+}
+
+/*
+ * Compare hit testing a board of cells by scanning and by grid
+ */
+static void hit_test_bench(gui_t* gui, int side)
+{
+  gui_menu_t* menu = gui_menu_create(gui, "hit-test");
+
+  gui_active_menu_set(gui, "hit-test");
+
+  gui_window_t* board = board_create(gui, menu, side);
+
+  if (!board)
+  {
+    gui_menu_destroy(gui, "hit-test");
+
+    return;
+  }
+
+  volatile size_t hit_count = 0;
+
+  srand(1);
+
+  double start = time_us_get();
+
+  for (int index = 0; index < HIT_TEST_COUNT; index++)
+  {
+    int x = rand() % gui->width;
+    int y = rand() % gui->height;
+
+    hit_count += (gui_windows_x_and_y_scan(board->children, board->child_count, x, y) != NULL);
+  }
+
+  result_print("hit-test-scan", board->child_count, (time_us_get() - start) / HIT_TEST_COUNT);
+
+  srand(1);
+
+  // The first hit test builds the grid
+  gui_x_and_y_window_get(gui, 0, 0);
+
+  start = time_us_get();
+
+  for (int index = 0; index < HIT_TEST_COUNT; index++)
+  {
+    int x = rand() % gui->width;
+    int y = rand() % gui->height;
+
+    hit_count += (gui_x_and_y_window_get(gui, x, y) != board);
+  }
+
+  result_print("hit-test-grid", board->child_count, (time_us_get() - start) / HIT_TEST_COUNT);
+
+  gui_menu_destroy(gui, "hit-test");
+}
+
+/*
+ * Handler that does nothing, to measure dispatch alone
+ */
+static void* bench_event_handle(gui_t* gui)
+{
+  (void) gui;
+
+  return NULL;
+}
+
+/*
+ * Trigger an event with handler_count handlers, by name and by ID
+ */
+static void event_bench(gui_t* gui, size_t handler_count)
+{
+  static char names[64][32];
+
+  static size_t name_count = 0;
+
+  if (name_count >= 64) return;
+
+  char* name = names[name_count++];
+
+  snprintf(name, sizeof(names[0]), "bench-%zu", handler_count);
+
+  for (size_t index = 0; index < handler_count; index++)
+  {
+    gui_event_create(gui, name, (gui_event_handler_t) {
+      .type = GUI_EVENT_HANDLER_GUI,
+      .handler.gui = &bench_event_handle
+    });
+  }
+
+  double start = time_us_get();
+
+  for (int index = 0; index < TRIGGER_COUNT; index++)
+  {
+    gui_user_event_trigger(gui, name);
+  }
+
+  result_print("event-trigger-name", handler_count, (time_us_get() - start) / TRIGGER_COUNT);
+
+  int id = gui_event_id_get(gui, name);
+
+  start = time_us_get();
+
+  for (int index = 0; index < TRIGGER_COUNT; index++)
+  {
+    gui_user_event_id_trigger(gui, id);
+  }
+
+  result_print("event-trigger-id", handler_count, (time_us_get() - start) / TRIGGER_COUNT);
+}
+
+/*
+ * Render frames of a menu with window_count windows,
+ * with every window changed, and with one window changed
+ */
+static void frame_bench(gui_t* gui, const char* prefix, size_t window_count)
+{
+  char name[32];
+
+  gui_menu_t* menu = bench_menu_create(gui, window_count);
+
+  if (!menu) return;
+
+  gui_render(gui);
+
+  double start = time_us_get();
+
+  for (int frame = 0; frame < FRAME_COUNT; frame++)
+  {
+    for (size_t index = 0; index < menu->window_count; index++)
+    {
+      gui_window_clear(menu->windows[index]);
+    }
+
+    gui_render(gui);
+  }
+
+  snprintf(name, sizeof(name), "%s-full", prefix);
+
+  result_print(name, window_count, (time_us_get() - start) / FRAME_COUNT);
+
+  start = time_us_get();
+
+  for (int frame = 0; frame < FRAME_COUNT; frame++)
+  {
+    gui_window_clear(menu->windows[frame % menu->window_count]);
+
+    gui_render(gui);
+  }
+
+  snprintf(name, sizeof(name), "%s-one", prefix);
+
+  result_print(name, window_count, (time_us_get() - start) / FRAME_COUNT);
+
+  gui_menu_destroy(gui, "bench");
+}
+
+/*
+ * Write count noisy PNG files of size, that are slow to decode
+ */
+static int png_files_create(char (*paths)[32], const char* prefix, int count, int size)
+{
+  SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_RGBA8888);
+
+  if (!surface) return 1;
+
+  srand(1);
+
+  for (int index = 0; index < count; index++)
+  {
+    Uint32* pixels = surface->pixels;
+
+    for (int pixel = 0; pixel < size * size; pixel++)
+    {
+      pixels[pixel] = (Uint32) rand() | 0xff;
+    }
+
+    snprintf(paths[index], 32, "%s-%d.png", prefix, index);
+
+    if (IMG_SavePNG(surface, paths[index]) != 0)
+    {
+      fprintf(stderr, "IMG_SavePNG: %s\n", IMG_GetError());
+
+      SDL_FreeSurface(surface);
+
+      return 2;
+    }
+  }
+
+  SDL_FreeSurface(surface);
+
+  return 0;
+}
+
+/*
+ * Load LOAD_COUNT textures with gui_textures_load,
+ * with 1 worker and up to one worker per CPU
+ */
+static void load_bench(gui_t* gui)
+{
+  static char paths[LOAD_COUNT][32];
+
+  static char names[LOAD_MAX_RUNS][LOAD_COUNT][32];
+
+  if (png_files_create(paths, "bench-load", LOAD_COUNT, LOAD_SIZE) == 0)
+  {
+    int cpu_count = SDL_GetCPUCount();
+
+    int run = 0;
+
+    for (int worker_count = 1; run < LOAD_MAX_RUNS; worker_count *= 2, run++)
+    {
+      worker_count = MIN(worker_count, cpu_count);
+
+      gui_asset_t assets[LOAD_COUNT];
+
+      // Each run adds its own textures, as textures can't be unloaded
+      for (int index = 0; index < LOAD_COUNT; index++)
+      {
+        snprintf(names[run][index], 32, "load-%d-%d", run, index);
+
+        assets[index] = (gui_asset_t) { names[run][index], paths[index] };
+      }
+
+      gui_load_worker_count_set(gui, worker_count);
+
+      double start = time_us_get();
+
+      gui_textures_load(gui, assets, LOAD_COUNT);
+
+      result_print("texture-load", worker_count, (time_us_get() - start) / LOAD_COUNT);
+
+      if (worker_count == cpu_count) break;
+    }
+  }
+
+  for (int index = 0; index < LOAD_COUNT; index++)
+  {
+    remove(paths[index]);
+  }
+}
+
+/*
+ * Draw ICON_COUNT icons to the menu, and render the frame
+ */
+static void icon_frame_render(gui_t* gui, gui_menu_t* menu, char names[ICON_COUNT][32])
+{
+  for (int index = 0; index < ICON_COUNT; index++)
+  {
+    gui_menu_texture_render(menu, names[index],
+      (gui_rect_t) {
+        .width  = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = ICON_SIZE },
+        .height = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = ICON_SIZE },
+        .xpos   = GUI_POS_LEFT,
+        .ypos   = GUI_POS_TOP,
+        .left   = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = (index % 16) * ICON_SIZE },
+        .top    = (gui_size_t) { .type = GUI_SIZE_ABS, .value.abs = (index / 16) * ICON_SIZE }
+      }
+    );
+  }
+
+  gui_render(gui);
+}
+
+/*
+ * Draw ICON_COUNT small textures per frame, with and without the texture atlas
+ */
+static void sprite_bench(gui_t* gui)
+{
+  static char paths[ICON_COUNT][32];
+
+  static char names[2][ICON_COUNT][32];
+
+  if (png_files_create(paths, "bench-icon", ICON_COUNT, ICON_SIZE) == 0)
+  {
+    gui_menu_t* menu = bench_menu_create(gui, 0);
+
+    for (int run = 0; menu && run < 2; run++)
+    {
+      bool is_packed = (run == 1);
+
+      gui_asset_t assets[ICON_COUNT];
+
+      for (int index = 0; index < ICON_COUNT; index++)
+      {
+        snprintf(names[run][index], 32, "icon-%d-%d", run, index);
+
+        assets[index] = (gui_asset_t) { names[run][index], paths[index] };
+      }
+
+      gui_texture_atlas_set(gui, is_packed);
+
+      if (gui_textures_load(gui, assets, ICON_COUNT) != 0) continue;
+
+      gui_stats_reset(gui);
+
+      double start = time_us_get();
+
+      for (int frame = 0; frame < FRAME_COUNT; frame++)
+      {
+        icon_frame_render(gui, menu, names[run]);
+      }
+
+      double us = (time_us_get() - start) / FRAME_COUNT;
+
+      size_t draw_call_count = gui_stats_get(gui).draw_call_count / FRAME_COUNT;
+
+      result_draw_print(is_packed ? "sprite-atlas" : "sprite-single", ICON_COUNT, us, draw_call_count);
+    }
+
+    gui_texture_atlas_set(gui, false);
+
+    gui_menu_destroy(gui, "bench");
+  }
+
+  for (int index = 0; index < ICON_COUNT; index++)
+  {
+    remove(paths[index]);
+  }
+}
+
+/*
+ * Main function
+ */
+int main(int argc, char* argv[])
+{
+  gui_backend_t backend = GUI_BACKEND_NULL;
+
+  char* font_path = "../minesweeper/assets/fonts/font.ttf";
+
+  for (int index = 1; index < argc; index++)
+  {
+    if (strcmp(argv[index], "--software") == 0)
+    {
+      backend = GUI_BACKEND_SOFTWARE;
+    }
+    else font_path = argv[index];
+  }
+
+  // Build machines have no display or sound card
+  setenv("SDL_VIDEODRIVER", "dummy", 0);
+  setenv("SDL_AUDIODRIVER", "dummy", 0);
+
+  if (gui_init() != 0)
+  {
+    fprintf(stderr, "gui_init: %s", strerror(errno));
+
+    return 1;
+  }
+
+  gui_t* gui = gui_backend_create(800, 600, "Benchmark", backend);
+
+  if (gui)
+  {
+    printf("{\n  \"backend\": \"%s\",\n  \"results\": [", (backend == GUI_BACKEND_NULL) ? "null" : "software");
+
+    layout_bench();
+
+    for (size_t count = 1; count <= TEXTURE_MAX_COUNT; count *= 10)
+    {
+      texture_render_bench(gui, count);
+    }
+
+    text_bench(gui, font_path);
+
+    for (int side = 4; side <= 64; side *= 2)
+    {
+      hit_test_bench(gui, side);
+    }
+
+    for (size_t count = 1; count <= 1000; count *= 10)
+    {
+      event_bench(gui, count);
+    }
+
+    for (size_t count = 10; count <= 10000; count *= 10)
+    {
+      frame_bench(gui, "frame", count);
+    }
+
+    // The same frames, with windows drawn straight to the screen
+    if (gui_composite_mode_set(gui, GUI_COMPOSITE_DIRECT) == 0)
+    {
+      for (size_t count = 10; count <= 10000; count *= 10)
+      {
+        frame_bench(gui, "frame-direct", count);
+      }
+
+      gui_composite_mode_set(gui, GUI_COMPOSITE_TEXTURE);
+    }
+
+    load_bench(gui);
+
+    sprite_bench(gui);
+
+    printf("\n  ]\n}\n");
+
+    gui_destroy(&gui);
+  }
+
+  gui_quit();
+
+  return 0;
+}
@@ -7,14 +7,20 @@
  *
  *
  * Events
+ * quit
+ * resize
+ * key-down
+ * key-up
+ * mouse-motion
  * mouse-down-left
  * mouse-down-right
  * mouse-up-left
  * mouse-up-right
- * key-down
- * key-up
- * resize
- * quit
+ * window-enter
+ * window-exit
+ * frame
+ * load-progress
+ * load-done
  */
 
 #ifndef GUI_H
@@ -47,6 +53,11 @@ typedef struct gui_border_t
   int         thickness;
   int         opacity;
   gui_color_t color;
+  int         top;    // Thickness of each side, used instead
+  int         right;  // of thickness if any of them is set
+  int         bottom;
+  int         left;
+  int         radius; // Radius of rounded outer corners
 } gui_border_t;
 
 /*
@@ -59,6 +70,48 @@ typedef struct gui_text_t
   gui_color_t color;
 } gui_text_t;
 
+/*
+ * Engine used to render text
+ */
+typedef enum gui_text_engine_t
+{
+  GUI_TEXT_ENGINE_ATLAS, // Glyphs from a shared atlas, drawn as quads
+  GUI_TEXT_ENGINE_CACHE  // One cached texture per (font, text, color)
+} gui_text_engine_t;
+
+/*
+ * How windows are composited to the screen
+ */
+typedef enum gui_composite_t
+{
+  GUI_COMPOSITE_TEXTURE, // Every window is rendered to its own texture
+  GUI_COMPOSITE_DIRECT   // Windows are drawn to the screen, clipped to their area
+} gui_composite_t;
+
+/*
+ * Backend that the gui renders with
+ */
+typedef enum gui_backend_t
+{
+  GUI_BACKEND_WINDOW,   // Window with accelerated renderer
+  GUI_BACKEND_SOFTWARE, // Offscreen software renderer, without window
+  GUI_BACKEND_NULL      // Software renderer with 1x1 targets, skips pixel work
+} gui_backend_t;
+
+/*
+ * Ticket of asynchronous asset load
+ */
+typedef int gui_ticket_t;
+
+#define GUI_TICKET_NONE (-1)
+
+/*
+ * Handle of loaded asset, resolved once from its name
+ */
+typedef int gui_handle_t;
+
+#define GUI_HANDLE_NONE (-1)
+
 /*
  *
  */
@@ -124,6 +177,45 @@ typedef struct gui_rect_t
   gui_pos_t  ypos;   // Vertical   alignment
 } gui_rect_t;
 
+/*
+ * Counters of the work done by the renderer
+ */
+typedef struct gui_stats_t
+{
+  size_t frame_count;      // Calls to gui_render
+  size_t idle_frame_count; // Frames skipped, because nothing changed
+  size_t present_count;    // Calls to SDL_RenderPresent
+  size_t composite_count;  // Windows composited into their parent
+  size_t target_switch_count;       // Calls to SDL_SetRenderTarget
+  size_t target_switch_avoided_count; // Target switches that were not needed
+  size_t motion_coalesced_count;      // Mouse motions merged into a later one
+  size_t hit_test_skipped_count;      // Mouse motions inside the hovered window
+  size_t draw_call_count;             // Calls to SDL_RenderCopy and SDL_RenderGeometry
+  size_t sprite_batched_count;        // Sprites drawn in the same call as the previous sprite
+  uint64_t loop_us;                   // Time spent in gui_start
+  uint64_t wait_us;                   // Time gui_start was blocked waiting for events
+  size_t evicted_count;               // Textures released to stay within the memory budget
+  size_t target_create_count;         // Render targets allocated
+  size_t target_reuse_count;          // Render targets recycled, or kept on resize
+  size_t resize_coalesced_count;      // Window size changes merged into a later resize
+  size_t direct_draw_count;           // Drawings replayed to the screen in direct mode
+  size_t culled_count;                // Windows skipped, because they were covered or outside of their parent
+  size_t border_batched_count;        // Borders drawn in the same call as the previous border
+} gui_stats_t;
+
+/*
+ * Texture memory in use, in bytes
+ */
+typedef struct gui_memory_t
+{
+  size_t texture_bytes; // Loaded textures that are not packed
+  size_t atlas_bytes;   // Texture atlas pages and glyph atlases
+  size_t text_bytes;    // Text cache
+  size_t target_bytes;  // Render targets of menus and windows, and pooled ones
+  size_t total_bytes;
+  size_t budget_bytes;  // 0 if there is no budget
+} gui_memory_t;
+
 /*
  *
  */
@@ -140,6 +232,30 @@ typedef struct gui_assets_t gui_assets_t;
  * Event
  */
 
+/*
+ * ID of built-in event, in the same order as the names above
+ *
+ * User events get IDs from GUI_EVENT_COUNT and up
+ */
+typedef enum gui_event_id_t
+{
+  GUI_EVENT_QUIT,
+  GUI_EVENT_RESIZE,
+  GUI_EVENT_KEY_DOWN,
+  GUI_EVENT_KEY_UP,
+  GUI_EVENT_MOUSE_MOTION,
+  GUI_EVENT_MOUSE_DOWN_LEFT,
+  GUI_EVENT_MOUSE_DOWN_RIGHT,
+  GUI_EVENT_MOUSE_UP_LEFT,
+  GUI_EVENT_MOUSE_UP_RIGHT,
+  GUI_EVENT_WINDOW_ENTER,
+  GUI_EVENT_WINDOW_EXIT,
+  GUI_EVENT_FRAME,       // Every frame, while an animation is running
+  GUI_EVENT_LOAD_PROGRESS, // An asset of an asynchronous load was added
+  GUI_EVENT_LOAD_DONE,     // All assets of an asynchronous load were added
+  GUI_EVENT_COUNT
+} gui_event_id_t;
+
 /*
  *
  */
@@ -149,7 +265,8 @@ typedef enum gui_event_handler_type_t
   GUI_EVENT_HANDLER_MOUSE,  // Get position of mouse
   GUI_EVENT_HANDLER_KEY,    // Get pressed key
   GUI_EVENT_HANDLER_RESIZE, // Get new size of screen
-  GUI_EVENT_HANDLER_WINDOW  // Get window
+  GUI_EVENT_HANDLER_WINDOW, // Get window
+  GUI_EVENT_HANDLER_LOAD    // Get progress of asynchronous load
 } gui_event_handler_type_t;
 
 /*
@@ -165,6 +282,7 @@ typedef struct gui_event_handler_t
     void* (*key)   (gui_t* gui, int key);
     void* (*resize)(gui_t* gui, int width, int height);
     void* (*window)(gui_t* gui, gui_window_t* window);
+    void* (*load)  (gui_t* gui, gui_ticket_t ticket, size_t loaded_count, size_t count);
   } handler;
 } gui_event_handler_t;
 
@@ -178,6 +296,8 @@ extern void   gui_quit(void);
 
 extern gui_t* gui_create(int width, int height, char* title);
 
+extern gui_t* gui_backend_create(int width, int height, char* title, gui_backend_t backend);
+
 extern void   gui_start(gui_t* gui, int fps);
 
 extern void   gui_stop(gui_t* gui);
@@ -194,22 +314,64 @@ extern int    gui_text_render(gui_t* gui, char* menu_name, char** window_names,
 
 extern int    gui_event_create(gui_t* gui, char* name, gui_event_handler_t handler);
 
+extern int    gui_event_id_get(gui_t* gui, char* name);
+
 extern void   gui_user_event_trigger(gui_t* gui, char* name);
 
+extern void   gui_user_event_id_trigger(gui_t* gui, int id);
+
+extern int    gui_text_cache_budget_set(gui_t* gui, size_t bytes);
+
+extern int    gui_text_engine_set(gui_t* gui, gui_text_engine_t engine);
+
+extern int    gui_composite_mode_set(gui_t* gui, gui_composite_t mode);
+
+extern int    gui_motion_coalesce_set(gui_t* gui, bool is_coalesced);
+
+extern int    gui_resize_delay_set(gui_t* gui, int delay_ms);
+
+extern int    gui_texture_atlas_set(gui_t* gui, bool is_packed);
+
+extern gui_stats_t gui_stats_get(gui_t* gui);
+
+extern void   gui_stats_reset(gui_t* gui);
+
+extern gui_memory_t gui_memory_get(gui_t* gui);
+
+extern int    gui_memory_budget_set(gui_t* gui, size_t bytes);
+
+extern float  gui_idle_percent_get(gui_t* gui);
+
+extern void   gui_animation_start(gui_t* gui);
+
+extern void   gui_animation_stop(gui_t* gui);
+
+extern int    gui_profile_dump(gui_t* gui, const char* filepath);
+
+extern void   gui_profile_exit_dump_set(gui_t* gui, const char* filepath);
+
 /*
  * Menu
  */
 
-extern void          gui_active_menu_set(gui_t* gui, char* name);
+extern int           gui_active_menu_set(gui_t* gui, char* name);
 
 extern gui_menu_t*   gui_menu_create(gui_t* gui, char* name);
 
+extern gui_menu_t*   gui_menu_get(gui_t* gui, const char* name);
+
 extern int           gui_menu_destroy(gui_t* gui, const char* name);
 
 extern gui_window_t* gui_menu_window_create(gui_menu_t* menu, char* name, gui_rect_t gui_rect, gui_border_t border);
 
 extern int           gui_menu_window_destroy(gui_menu_t* menu, char* name);
 
+extern int           gui_menu_texture_render(gui_menu_t* menu, char* name, gui_rect_t gui_rect);
+
+extern int           gui_menu_texture_handle_render(gui_menu_t* menu, gui_handle_t texture, gui_rect_t gui_rect);
+
+extern int           gui_menu_text_handle_render(gui_menu_t* menu, gui_handle_t font, char* text, gui_color_t color, gui_rect_t gui_rect);
+
 /*
  * Window
  */
@@ -224,16 +386,62 @@ extern gui_window_t* gui_window_child_create(gui_window_t* window, char* name, g
 
 extern int           gui_window_child_destroy(gui_window_t* window, char* name);
 
+extern gui_window_t* gui_window_get(gui_t* gui, char* menu_name, char** window_names);
+
+extern int           gui_window_clear(gui_window_t* window);
+
+extern int           gui_window_cached_set(gui_window_t* window, bool is_cached);
+
+extern int           gui_window_opaque_set(gui_window_t* window, bool is_opaque);
+
+extern int           gui_window_texture_render(gui_window_t* window, char* name, gui_rect_t gui_rect);
+
+extern int           gui_window_texture_handle_render(gui_window_t* window, gui_handle_t texture, gui_rect_t gui_rect);
+
+extern int           gui_window_text_handle_render(gui_window_t* window, gui_handle_t font, char* text, gui_color_t color, gui_rect_t gui_rect);
+
 /*
  * Assets
  */
 
 extern int gui_textures_load(gui_t* gui, gui_asset_t* assets, size_t count);
 
+extern int gui_textures_register(gui_t* gui, gui_asset_t* assets, size_t count);
+
 extern int gui_fonts_load(gui_t* gui, gui_asset_t* assets, size_t count);
 
 extern int gui_chunks_load(gui_t* gui, gui_asset_t* assets, size_t count);
 
+extern int gui_load_worker_count_set(gui_t* gui, int count);
+
+extern int gui_bundle_load(gui_t* gui, const char* filepath);
+
+extern gui_ticket_t gui_textures_load_async(gui_t* gui, gui_asset_t* assets, size_t count);
+
+extern gui_ticket_t gui_fonts_load_async(gui_t* gui, gui_asset_t* assets, size_t count);
+
+extern gui_ticket_t gui_chunks_load_async(gui_t* gui, gui_asset_t* assets, size_t count);
+
+extern bool         gui_load_is_done(gui_t* gui, gui_ticket_t ticket);
+
+extern float        gui_load_progress_get(gui_t* gui, gui_ticket_t ticket);
+
+extern int          gui_load_wait(gui_t* gui, gui_ticket_t ticket);
+
+extern int          gui_load_budget_set(gui_t* gui, int budget_us);
+
+extern int          gui_menu_preload_set(gui_t* gui, char* menu_name, char** texture_names);
+
+extern gui_ticket_t gui_menu_preload(gui_t* gui, char* menu_name);
+
+extern gui_handle_t gui_texture_handle_get(gui_t* gui, const char* name);
+
+extern gui_handle_t gui_font_handle_get(gui_t* gui, const char* name);
+
+extern gui_handle_t gui_chunk_handle_get(gui_t* gui, const char* name);
+
+extern int          gui_chunk_handle_play(gui_t* gui, gui_handle_t chunk);
+
 #endif // GUI_H
 
 /*
@@ -246,12 +454,126 @@ extern int gui_chunks_load(gui_t* gui, gui_asset_t* assets, size_t count);
 
 #include <stdbool.h>
 #include <errno.h>
+#include <limits.h>
+#include <math.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif // _WIN32
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_mixer.h>
 #include <SDL2/SDL_ttf.h>
 
+/*
+ * Default memory budget of the text texture cache
+ */
+#ifndef GUI_TEXT_CACHE_BUDGET
+#define GUI_TEXT_CACHE_BUDGET (4 * 1024 * 1024)
+#endif
+
+/*
+ * Initial size of the glyph atlas of a font
+ */
+#ifndef GUI_GLYPH_ATLAS_SIZE
+#define GUI_GLYPH_ATLAS_SIZE 512
+#endif
+
+#define GUI_GLYPH_COUNT 256
+
+/*
+ * Size of the pages of the texture atlas
+ */
+#ifndef GUI_TEXTURE_ATLAS_SIZE
+#define GUI_TEXTURE_ATLAS_SIZE 1024
+#endif
+
+/*
+ * Textures with a larger side than this get their own texture
+ */
+#ifndef GUI_TEXTURE_ATLAS_MAX_SIDE
+#define GUI_TEXTURE_ATLAS_MAX_SIDE 256
+#endif
+
+/*
+ * Empty pixels between packed textures, so they don't bleed when scaled
+ */
+#define GUI_TEXTURE_ATLAS_PADDING 1
+
+/*
+ * Default texture memory budget, 0 for no budget
+ */
+#ifndef GUI_MEMORY_BUDGET
+#define GUI_MEMORY_BUDGET 0
+#endif
+
+/*
+ * Smallest step that the sides of render targets are rounded up to
+ */
+#ifndef GUI_TARGET_BUCKET_SIZE
+#define GUI_TARGET_BUCKET_SIZE 64
+#endif
+
+/*
+ * Number of unused render targets kept for reuse
+ */
+#ifndef GUI_TARGET_POOL_COUNT
+#define GUI_TARGET_POOL_COUNT 8
+#endif
+
+/*
+ * Most uncovered parts of a window, that occlusion culling follows
+ */
+#ifndef GUI_COVER_PART_COUNT
+#define GUI_COVER_PART_COUNT 16
+#endif
+
+/*
+ * Time the window size has to be stable, before the resize event
+ */
+#ifndef GUI_RESIZE_DELAY_MS
+#define GUI_RESIZE_DELAY_MS 150
+#endif
+
+/*
+ * Number of timings kept by the profiler, if GUI_PROFILE is defined
+ */
+#ifndef GUI_PROFILE_CAPACITY
+#define GUI_PROFILE_CAPACITY 65536
+#endif
+
+/*
+ * Default time per frame spent on uploading asynchronously loaded assets
+ */
+#ifndef GUI_LOAD_BUDGET_US
+#define GUI_LOAD_BUDGET_US 4000
+#endif
+
+/*
+ * Number of asset loading worker threads, 0 for one per CPU
+ */
+#ifndef GUI_LOAD_WORKER_COUNT
+#define GUI_LOAD_WORKER_COUNT 0
+#endif
+
+/*
+ * Containers with fewer windows than this are hit tested linearly
+ */
+#ifndef GUI_GRID_MIN_COUNT
+#define GUI_GRID_MIN_COUNT 16
+#endif
+
+/*
+ * Max number of cells along one side of a hit test grid
+ */
+#ifndef GUI_GRID_MAX_SIDE
+#define GUI_GRID_MAX_SIDE 64
+#endif
+
 /*
  * Initialize SDL drivers
  */
@@ -367,6 +689,52 @@ static inline void sdl_renderer_destroy(SDL_Renderer** renderer)
   *renderer = NULL;
 }
 
+/*
+ * Create SDL Surface for offscreen rendering
+ */
+static inline SDL_Surface* sdl_surface_create(int width, int height)
+{
+  SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA8888);
+
+  if (!surface)
+  {
+    fprintf(stderr, "SDL_CreateRGBSurfaceWithFormat: %s\n", SDL_GetError());
+
+    return NULL;
+  }
+
+  return surface;
+}
+
+/*
+ * Destroy SDL Surface
+ */
+static inline void sdl_surface_destroy(SDL_Surface** surface)
+{
+  if (!surface || !(*surface)) return;
+
+  SDL_FreeSurface(*surface);
+
+  *surface = NULL;
+}
+
+/*
+ * Create SDL software Renderer, which renders to surface
+ */
+static inline SDL_Renderer* sdl_software_renderer_create(SDL_Surface* surface)
+{
+  SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(surface);
+
+  if (!renderer)
+  {
+    fprintf(stderr, "SDL_CreateSoftwareRenderer: %s\n", SDL_GetError());
+
+    return NULL;
+  }
+
+  return renderer;
+}
+
 /*
  * Destroy SDL Texture
  */
@@ -379,6 +747,23 @@ static inline void sdl_texture_destroy(SDL_Texture** texture)
   *texture = NULL;
 }
 
+/*
+ * Get memory used by SDL Texture
+ */
+static inline size_t sdl_texture_bytes_get(SDL_Texture* texture)
+{
+  Uint32 format;
+  int    width;
+  int    height;
+
+  if (!texture || SDL_QueryTexture(texture, &format, NULL, &width, &height) != 0)
+  {
+    return 0;
+  }
+
+  return (size_t) width * height * SDL_BYTESPERPIXEL(format);
+}
+
 /*
  * Create SDL Texture
  */
@@ -478,42 +863,13 @@ static inline int sdl_target_set(SDL_Renderer* renderer, SDL_Texture* target)
 }
 
 /*
- * Clear the supplied texture
- */
-static inline int sdl_target_clear(SDL_Renderer* renderer, SDL_Texture* target)
-{
-  SDL_Texture* old_target = SDL_GetRenderTarget(renderer);
-
-  // 1. Temporarly set the new target
-  if (sdl_target_set(renderer, target) != 0)
-  {
-    return 1;
-  }
-
-  if (SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255) != 0)
-  {
-    return 2;
-  }
-
-  SDL_RenderClear(renderer);
-
-  // 2. Change back to the old target
-  if (sdl_target_set(renderer, old_target) != 0)
-  {
-    return 3;
-  }
-
-  return 0;
-}
-
-/*
- *
+ * Fill rects with the current draw color, in one call
  */
-static inline int sdl_rect_render(SDL_Renderer* renderer, SDL_Rect* rect)
+static inline int sdl_rects_render(SDL_Renderer* renderer, SDL_Rect* rects, int count)
 {
-  if (SDL_RenderFillRect(renderer, rect) != 0)
+  if (SDL_RenderFillRects(renderer, rects, count) != 0)
   {
-    fprintf(stderr, "SDL_RenderFillRect: %s\n", SDL_GetError());
+    fprintf(stderr, "SDL_RenderFillRects: %s\n", SDL_GetError());
 
     return 1;
   }
@@ -535,74 +891,90 @@ static inline SDL_Color sdl_color_create(gui_color_t color)
 }
 
 /*
- * Render a border around rect
+ * Get the thickness of each side of border
  */
-static inline int sdl_border_render(SDL_Renderer* renderer, gui_border_t border, SDL_Rect rect)
+static inline void sdl_border_sides_get(gui_border_t border, int* top, int* right, int* bottom, int* left)
 {
-  SDL_Color color = sdl_color_create(border.color);
-
-  if (SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, border.opacity) != 0)
+  if (border.top || border.right || border.bottom || border.left)
   {
-    return 1;
+    *top    = border.top;
+    *right  = border.right;
+    *bottom = border.bottom;
+    *left   = border.left;
+  }
+  else
+  {
+    *top    = border.thickness;
+    *right  = border.thickness;
+    *bottom = border.thickness;
+    *left   = border.thickness;
   }
+}
+
+/*
+ * Get rect of window including its border
+ */
+static inline SDL_Rect sdl_border_rect_get(gui_border_t border, SDL_Rect rect)
+{
+  int top, right, bottom, left;
+
+  sdl_border_sides_get(border, &top, &right, &bottom, &left);
 
-  // Draw top border
-  SDL_Rect top =
+  return (SDL_Rect)
   {
-    rect.x - border.thickness,
-    rect.y - border.thickness,
-    rect.w + border.thickness * 2,
-    border.thickness
+    rect.x - left,
+    rect.y - top,
+    rect.w + left + right,
+    rect.h + top + bottom
   };
+}
+
+/*
+ * Create empty atlas texture, cleared to transparent
+ */
+static inline SDL_Texture* sdl_atlas_texture_create(SDL_Renderer* renderer, int width, int height)
+{
+  SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, width, height);
 
-  if (sdl_rect_render(renderer, &top) != 0)
+  if (!texture)
   {
-    return 2;
+    fprintf(stderr, "SDL_CreateTexture: %s\n", SDL_GetError());
+
+    return NULL;
   }
 
-  // Draw bottom border
-  SDL_Rect bottom =
-  {
-    rect.x - border.thickness,
-    rect.y + rect.h,
-    rect.w + border.thickness * 2,
-    border.thickness
-  };
-  
-  if (sdl_rect_render(renderer, &bottom) != 0)
+  if (SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND) != 0)
   {
-    return 3;
+    fprintf(stderr, "SDL_SetTextureBlendMode: %s\n", SDL_GetError());
+
+    SDL_DestroyTexture(texture);
+
+    return NULL;
   }
 
-  // Draw left border
-  SDL_Rect left =
-  {
-    rect.x - border.thickness,
-    rect.y - border.thickness,
-    border.thickness,
-    rect.h + border.thickness * 2
-  };
-  
-  if (sdl_rect_render(renderer, &left) != 0)
+  void* pixels = calloc((size_t) width * height, 4);
+
+  if (!pixels)
   {
-    return 4;
+    SDL_DestroyTexture(texture);
+
+    return NULL;
   }
 
-  // Draw right border
-  SDL_Rect right =
-  {
-    rect.x + rect.w,
-    rect.y - border.thickness,
-    border.thickness,
-    rect.h + border.thickness * 2
-  };
-  
-  if (sdl_rect_render(renderer, &right) != 0)
+  int status = SDL_UpdateTexture(texture, NULL, pixels, width * 4);
+
+  free(pixels);
+
+  if (status != 0)
   {
-    return 5;
+    fprintf(stderr, "SDL_UpdateTexture: %s\n", SDL_GetError());
+
+    SDL_DestroyTexture(texture);
+
+    return NULL;
   }
 
-  return 0;
+  return texture;
 }
 
 /*
@@ -623,70 +995,18 @@ static inline int sdl_texture_render(SDL_Renderer* renderer, SDL_Texture* textur
 }
 
 /*
- * Render a border around rect to target texture
+ * Render geometry with SDL Texture
  */
-static inline int sdl_target_border_render(SDL_Renderer* renderer, SDL_Texture* target, gui_border_t border, SDL_Rect rect)
+static inline int sdl_geometry_render(SDL_Renderer* renderer, SDL_Texture* texture, SDL_Vertex* vertices, int vertex_count, int* indices, int index_count)
 {
-  SDL_Texture* old_target = SDL_GetRenderTarget(renderer);
-
-  // 1. Temporarly set the new target
-  if (sdl_target_set(renderer, target) != 0)
-  {
-    return 1;
-  }
-
-  int status = sdl_border_render(renderer, border, rect);
+  int status = SDL_RenderGeometry(renderer, texture, vertices, vertex_count, indices, index_count);
 
-  // 2. Change back to the old target
-  if (sdl_target_set(renderer, old_target) != 0)
+  if (status != 0)
   {
-    return 2;
+    fprintf(stderr, "SDL_RenderGeometry: %s\n", SDL_GetError());
   }
 
-  return (status == 0) ? 0 : 3;
-}
-
-/*
- * Render texture to target texture
- */
-static inline int sdl_target_texture_render(SDL_Renderer* renderer, SDL_Texture* target, SDL_Texture* texture, SDL_Rect* rect)
-{
-  SDL_Texture* old_target = SDL_GetRenderTarget(renderer);
-
-  // 1. Temporarly set the new target
-  if (sdl_target_set(renderer, target) != 0)
-  {
-    return 1;
-  }
-
-  int status = sdl_texture_render(renderer, texture, rect);
-
-  // 2. Change back to the old target
-  if (sdl_target_set(renderer, old_target) != 0)
-  {
-    return 2;
-  }
-
-  return (status == 0) ? 0 : 3;
-}
-
-/*
- * Resize SDL Texture
- */
-static inline int sdl_texture_resize(SDL_Texture** texture, SDL_Renderer* renderer, int width, int height)
-{
-  SDL_Texture* new_texture = sdl_texture_create(renderer, width, height);
-
-  if (!new_texture)
-  {
-    return 1;
-  }
-
-  sdl_texture_destroy(texture);
-
-  *texture = new_texture;
-
-  return 0;
+  return status;
 }
 
 /*
@@ -733,22 +1053,87 @@ static inline void mix_chunk_destroy(Mix_Chunk** chunk)
   *chunk = NULL;
 }
 
+/*
+ * Segment of the skyline of an atlas page
+ */
+typedef struct gui_skyline_node_t
+{
+  int x;
+  int y;     // Height of the used area below the segment
+  int width;
+} gui_skyline_node_t;
+
+/*
+ * Page of the texture atlas, that small textures are packed into
+ *
+ * The used area is tracked as a skyline, and each texture is placed
+ * where its bottom edge ends up lowest
+ */
+typedef struct gui_atlas_page_t
+{
+  SDL_Texture*        texture;
+  int                 width;
+  int                 height;
+  gui_skyline_node_t* nodes;
+  size_t              node_count;
+} gui_atlas_page_t;
+
 /*
  *
  */
 typedef struct gui_texture_t
 {
-  char*        name;
-  SDL_Texture* texture;
+  char*             name;
+  char*             filepath; // Of registered texture, which is loaded on first use
+  SDL_Texture*      texture;  // The texture of page, if the texture is packed
+  SDL_Rect          rect;     // Rect of the texture in page
+  gui_atlas_page_t* page;     // NULL if the texture is not packed
+  size_t            bytes;    // Memory of texture, if it is not packed
+  uint64_t          used_frame;
+  bool              load_failed; // Lazy load failed, so it isn't tried again
 } gui_texture_t;
 
+/*
+ * Glyph in a glyph atlas
+ */
+typedef struct gui_glyph_t
+{
+  SDL_Rect rect;      // Rect of glyph in atlas texture
+  int      advance;   // Horizontal advance to next glyph
+  bool     is_loaded;
+} gui_glyph_t;
+
+/*
+ * Atlas of rasterized glyphs of a font
+ *
+ * Glyphs are rasterized white on first use, and tinted by vertex color
+ */
+typedef struct gui_glyph_atlas_t
+{
+  SDL_Texture* texture;
+  TTF_Font*    font;        // Font of glyphs, for kerning between them
+  int          width;
+  int          height;
+  int          pen_x;       // Position of next glyph in atlas
+  int          pen_y;
+  int          row_height;  // Height of current row in atlas
+  int          line_height;
+  gui_glyph_t  glyphs[GUI_GLYPH_COUNT];
+  size_t       raster_count; // Number of glyphs rasterized
+  SDL_Vertex*  vertices;     // Scratch buffers for string quads
+  int*         indices;
+  size_t       capacity;     // Number of quads in scratch buffers
+} gui_glyph_atlas_t;
+
 /*
  *
  */
 typedef struct gui_font_t
 {
-  char*     name;
-  TTF_Font* font;
+  char*              name;
+  TTF_Font*          font;
+  gui_glyph_atlas_t* atlas;
+  void*              data; // File data, if the font was opened from memory
 } gui_font_t;
 
 /*
@@ -769,24 +1154,119 @@ typedef struct gui_music_t
   Mix_Music* music;
 } gui_music_t;
 
+/*
+ * Slot in name index
+ */
+typedef struct gui_name_slot_t
+{
+  const char* name;  // Name, NULL if slot is empty
+  uint32_t    hash;
+  size_t      index; // Index of named item in its array
+} gui_name_slot_t;
+
+/*
+ * Open addressing hash index of names, used for assets and events
+ */
+typedef struct gui_name_index_t
+{
+  gui_name_slot_t* slots;
+  size_t           capacity; // Power of two
+  size_t           count;
+} gui_name_index_t;
+
+/*
+ * Bundle of packed assets, that is mapped or read into memory
+ */
+typedef struct gui_bundle_t
+{
+  void*  data;
+  size_t size;
+} gui_bundle_t;
+
 /*
  *
  */
 typedef struct gui_assets_t
 {
-  gui_texture_t** textures;
-  size_t          texture_count;
+  gui_texture_t**  textures;
+  size_t           texture_count;
+  gui_name_index_t texture_index;
+
+  gui_font_t**     fonts;
+  size_t           font_count;
+  gui_name_index_t font_index;
+
+  gui_chunk_t**    chunks;
+  size_t           chunk_count;
+  gui_name_index_t chunk_index;
+
+  gui_music_t**    musics;
+  size_t           music_count;
 
-  gui_font_t**    fonts;
-  size_t          font_count;
+  gui_bundle_t*    bundles; // Mapped bundles, which assets point into
+  size_t           bundle_count;
 
-  gui_chunk_t**   chunks;
-  size_t          chunk_count;
+  gui_atlas_page_t** pages; // Pages of the texture atlas
+  size_t             page_count;
 
-  gui_music_t**   musics;
-  size_t          music_count;
+  size_t           texture_bytes; // Memory of the textures that are not packed
 } gui_assets_t;
 
+/*
+ * Cell in hit test grid, with indices of the windows overlapping it
+ */
+typedef struct gui_grid_cell_t
+{
+  size_t* indices;  // Ascending, so the top window is last
+  size_t  count;
+  size_t  capacity;
+} gui_grid_cell_t;
+
+/*
+ * Uniform grid over the windows of a menu or window, used for hit testing
+ */
+typedef struct gui_grid_t
+{
+  gui_grid_cell_t* cells;
+  int              cols;
+  int              rows;
+  int              cell_w;
+  int              cell_h;
+  size_t           count;    // Number of windows the grid was sized for
+  bool             is_valid; // Grid matches the current windows
+} gui_grid_t;
+
+/*
+ * Kind of recorded drawing
+ */
+typedef enum gui_draw_kind_t
+{
+  GUI_DRAW_TEXTURE,
+  GUI_DRAW_TEXT,
+  GUI_DRAW_BORDER
+} gui_draw_kind_t;
+
+/*
+ * Drawing of a window or menu without texture, replayed every frame
+ */
+typedef struct gui_draw_t
+{
+  gui_draw_kind_t kind;
+  char*           name;     // Texture or font name
+  char*           text;
+  gui_color_t     color;
+  gui_rect_t      gui_rect; // Area of text, relative to the owner
+  SDL_Rect        rect;     // Area of texture or border, relative to the owner
+  gui_border_t    border;
+} gui_draw_t;
+
+typedef struct gui_draw_list_t
+{
+  gui_draw_t* draws;
+  size_t      count;
+  size_t      capacity;
+} gui_draw_list_t;
+
 /*
  *
  */
@@ -795,10 +1275,16 @@ typedef struct gui_window_t
   char*          name;
   gui_rect_t     gui_rect;
   SDL_Rect       sdl_rect;
-  SDL_Texture*   texture;
+  SDL_Texture*   texture;  // NULL if the window is drawn directly to the screen
+  gui_draw_list_t draw_list; // Drawings of window, if it has no texture
+  bool           is_cached; // Window keeps a texture in direct mode
+  bool           is_opaque; // Window hides everything below it
   gui_border_t   border;
   gui_window_t** children;
   size_t         child_count;
+  gui_grid_t     grid;     // Hit test grid of children
+  bool           is_dirty; // Window has changed since it was composited
+  SDL_Rect       damage;   // Changed area of window texture
   bool           is_child;
   union
   {
@@ -817,6 +1303,17 @@ typedef struct gui_menu_t
   SDL_Texture*   texture;
   gui_window_t** windows;
   size_t         window_count;
+  gui_grid_t     grid;     // Hit test grid of windows
+  bool           is_dirty; // Menu has changed since it was presented
+  SDL_Rect       damage;   // Changed area of menu texture
+  char**         preload_names; // Textures that are loaded before menu is shown
+  size_t         preload_count;
+  gui_ticket_t   preload_ticket;
+  bool           has_drawing; // Menu texture has drawings, that can't be composited again
+  uint64_t       used_frame;
+  int            width;  // Size of gui that the menu is laid out for
+  int            height;
+  gui_draw_list_t draw_list; // Drawings of menu in direct mode
   gui_t*         gui;
 } gui_menu_t;
 
@@ -830,12 +1327,123 @@ typedef struct gui_event_t
   size_t               handler_count;
 } gui_event_t;
 
+/*
+ * Cached texture of rendered text, keyed on (font, text, color)
+ */
+typedef struct gui_text_entry_t gui_text_entry_t;
+
+typedef struct gui_text_entry_t
+{
+  gui_font_t*       font;
+  char*             text;   // Copy of the rendered text
+  gui_color_t       color;
+  uint32_t          hash;
+  SDL_Texture*      texture;
+  int               width;
+  int               height;
+  size_t            bytes;  // Approximate memory used by entry
+  uint64_t          used_frame;
+  gui_text_entry_t* next;   // Next entry in the same bucket
+  gui_text_entry_t* newer;  // Next entry in LRU list
+  gui_text_entry_t* older;  // Previous entry in LRU list
+} gui_text_entry_t;
+
+/*
+ * Hash table of text entries, with LRU eviction
+ */
+typedef struct gui_text_cache_t
+{
+  gui_text_entry_t** buckets;
+  size_t             bucket_count;
+  size_t             entry_count;
+  gui_text_entry_t*  newest;
+  gui_text_entry_t*  oldest;
+  size_t             bytes;
+  size_t             budget;
+} gui_text_cache_t;
+
+/*
+ * Render state of the renderer, to skip redundant state changes
+ */
+typedef struct gui_render_state_t
+{
+  SDL_Texture* target;
+  bool         is_target_known;
+  SDL_Color    color;
+  bool         is_color_known;
+} gui_render_state_t;
+
+/*
+ * Unused render targets, the oldest first, that are recycled by size
+ */
+typedef struct gui_target_pool_t
+{
+  SDL_Texture* textures[GUI_TARGET_POOL_COUNT];
+  size_t       count;
+} gui_target_pool_t;
+
+/*
+ * Sprites from one atlas page to one target, that are drawn together
+ */
+typedef struct gui_sprite_batch_t
+{
+  SDL_Texture* target;
+  SDL_Texture* texture;
+  SDL_Vertex*  vertices;
+  int*         indices;
+  size_t       count;    // Number of sprites in batch
+  size_t       capacity;
+} gui_sprite_batch_t;
+
+/*
+ * Filled rects of one color to one target, that are drawn together
+ */
+typedef struct gui_rect_batch_t
+{
+  SDL_Texture* target;
+  SDL_Color    color;
+  SDL_Rect*    rects;
+  SDL_Rect     bounds;   // Area covered by the rects
+  size_t       count;    // Number of rects in batch
+  size_t       capacity;
+} gui_rect_batch_t;
+
+#ifdef GUI_PROFILE
+
+/*
+ * Timing of one profiled stage
+ */
+typedef struct gui_profile_entry_t
+{
+  const char* name;
+  const char* category;
+  uint64_t    start_us;
+  uint64_t    duration_us;
+} gui_profile_entry_t;
+
+/*
+ * Ring buffer of timings, where the oldest are overwritten
+ */
+typedef struct gui_profile_t
+{
+  gui_profile_entry_t* entries;
+  size_t               head;  // Index of next entry
+  size_t               count;
+  const char*          exit_path; // Trace file written by gui_destroy
+} gui_profile_t;
+
+#endif // GUI_PROFILE
+
+typedef struct gui_load_t gui_load_t;
+
 /*
  *
  */
 typedef struct gui_t
 {
-  SDL_Window*   window;
+  gui_backend_t backend;
+  SDL_Window*   window;  // NULL for the offscreen backends
+  SDL_Surface*  surface; // Surface of the offscreen backends
   SDL_Renderer* renderer;
   char*         title;
   int           width;
@@ -844,1765 +1452,7365 @@ typedef struct gui_t
   size_t        menu_count;
   char*         menu_name;
   gui_assets_t* assets;
-  gui_event_t** events;
+  gui_event_t** events;       // Indexed by event ID
   size_t        event_count;
+  gui_name_index_t event_index; // Event IDs by name
   bool          is_running;
+  size_t        animation_count; // Running animations, which need every frame
   gui_window_t* last_window;
   gui_window_t* curr_window;
+  SDL_Rect      hover_rect;      // Area where curr_window is hit
+  bool          is_hover_cached;
+  bool          is_motion_coalesced;
+  bool          is_motion_pending;
+  SDL_Event     motion_event;    // Latest mouse motion of poll batch
+  bool          is_resize_pending;
+  int           resize_width;    // Latest window size, not yet resized to
+  int           resize_height;
+  Uint32        resize_ticks;    // When the window size last changed
+  int           resize_delay_ms;
+  gui_text_cache_t  text_cache;
+  gui_text_engine_t text_engine;
+  gui_composite_t   composite;
+  gui_menu_t*       render_menu; // Menu presented by last gui_render
+  gui_render_state_t render_state;
+  gui_sprite_batch_t sprite_batch;
+  gui_rect_batch_t   rect_batch;
+  gui_target_pool_t  target_pool;
+  bool              is_texture_packed; // Pack loaded textures into atlas pages
+  gui_stats_t       stats;
+  uint64_t          frame_index;  // Incremented by every gui_render, to time uses
+  size_t            target_bytes; // Memory of render targets
+  size_t            memory_budget;
+  int               load_worker_count; // 0 for GUI_LOAD_WORKER_COUNT
+  gui_load_t**      loads;             // Asynchronous loads in progress
+  size_t            load_count;
+  gui_ticket_t      next_ticket;
+  int               load_budget_us;
+#ifdef GUI_PROFILE
+  gui_profile_t     profile;
+#endif // GUI_PROFILE
 } gui_t;
 
 /*
- * Assets
+ * Hash
  */
 
 /*
- * Create assets struct
+ * Hash string with FNV-1a, continuing from hash
  */
-static inline gui_assets_t* gui_assets_create(void)
+static inline uint32_t gui_string_hash(uint32_t hash, const char* string)
 {
-  gui_assets_t* assets = malloc(sizeof(gui_assets_t));
-
-  if (!assets)
+  for (const unsigned char* byte = (const unsigned char*) string; *byte; byte++)
   {
-    return NULL;
+    hash ^= *byte;
+    hash *= 16777619u;
   }
 
-  memset(assets, 0, sizeof(gui_assets_t));
-
-  return assets;
+  return hash;
 }
 
 /*
- * Destroy gui texture
+ * Hash bytes with FNV-1a, continuing from hash
  */
-static inline void gui_texture_destroy(gui_texture_t** texture)
+static inline uint32_t gui_bytes_hash(uint32_t hash, const void* bytes, size_t size)
 {
-  if (!texture || !(*texture)) return;
-
-  sdl_texture_destroy(&(*texture)->texture);
-
-  free(*texture);
+  for (size_t index = 0; index < size; index++)
+  {
+    hash ^= ((const unsigned char*) bytes)[index];
+    hash *= 16777619u;
+  }
 
-  *texture = NULL;
+  return hash;
 }
 
 /*
- * Destroy gui font
+ * Profile
  */
-static inline void gui_font_destroy(gui_font_t** font)
-{
-  if (!font || !(*font)) return;
-
-  ttf_font_destroy(&(*font)->font);
-
-  free(*font);
-
-  *font = NULL;
-}
 
 /*
- * Destroy gui chunk
+ * Get current time in microseconds
  */
-static inline void gui_chunk_destroy(gui_chunk_t** chunk)
+static inline uint64_t gui_time_us_get(void)
 {
-  if (!chunk || !(*chunk)) return;
-
-  mix_chunk_destroy(&(*chunk)->chunk);
-
-  free(*chunk);
+  uint64_t counter   = SDL_GetPerformanceCounter();
+  uint64_t frequency = SDL_GetPerformanceFrequency();
 
-  *chunk = NULL;
+  // Split up, so that the multiplication doesn't overflow
+  return (counter / frequency) * 1000000 + (counter % frequency) * 1000000 / frequency;
 }
 
+#ifdef GUI_PROFILE
+
 /*
- * Destroy gui music
+ * Start timing a stage, by storing the start time in variable
  */
-static inline void gui_music_destroy(gui_music_t** music)
-{
-  if (!music || !(*music)) return;
-
-  // mix_music_destroy(&(*music)->music);
-
-  free(*music);
+#define GUI_PROFILE_BEGIN(variable) uint64_t variable = gui_time_us_get()
 
-  *music = NULL;
-}
+/*
+ * Stop timing a stage, and record it under name and category
+ */
+#define GUI_PROFILE_END(gui, variable, name, category) gui_profile_record((gui), (name), (category), (variable))
 
 /*
- * Destroy assets struct
+ * Record timing of stage that started at start_us and ends now
  */
-static inline void gui_assets_destroy(gui_assets_t** assets)
+static inline void gui_profile_record(gui_t* gui, const char* name, const char* category, uint64_t start_us)
 {
-  if (!assets || !(*assets)) return;
+  gui_profile_t* profile = &gui->profile;
 
-  for (size_t index = 0; index < (*assets)->texture_count; index++)
+  if (!profile->entries)
   {
-    gui_texture_destroy(&(*assets)->textures[index]);
-  }
-
-  free((*assets)->textures);
-
+    profile->entries = malloc(sizeof(gui_profile_entry_t) * GUI_PROFILE_CAPACITY);
 
-  for (size_t index = 0; index < (*assets)->font_count; index++)
-  {
-    gui_font_destroy(&(*assets)->fonts[index]);
+    if (!profile->entries) return;
   }
 
-  free((*assets)->fonts);
-
-
-  for (size_t index = 0; index < (*assets)->chunk_count; index++)
+  profile->entries[profile->head] = (gui_profile_entry_t)
   {
-    gui_chunk_destroy(&(*assets)->chunks[index]);
-  }
-
-  free((*assets)->chunks);
+    .name        = name,
+    .category    = category,
+    .start_us    = start_us,
+    .duration_us = gui_time_us_get() - start_us
+  };
 
+  profile->head = (profile->head + 1) % GUI_PROFILE_CAPACITY;
 
-  for (size_t index = 0; index < (*assets)->music_count; index++)
+  if (profile->count < GUI_PROFILE_CAPACITY)
   {
-    gui_music_destroy(&(*assets)->musics[index]);
+    profile->count++;
   }
-
-  free((*assets)->musics);
-
-
-  free(*assets);
-
-  *assets = NULL;
 }
 
 /*
- * Create gui_texture (This is an internal function)
+ * Write string as JSON string, escaping quotes and control characters
  */
-static inline gui_texture_t* gui_texture_create(char* name, SDL_Texture* texture)
+static inline void gui_profile_string_write(FILE* file, const char* string)
 {
-  gui_texture_t* gui_texture = malloc(sizeof(gui_texture_t));
+  fputc('"', file);
 
-  if (!gui_texture)
+  for (const char* symbol = string; *symbol; symbol++)
   {
-    return NULL;
-  }
+    if (*symbol == '"' || *symbol == '\\')
+    {
+      fputc('\\', file);
+    }
 
-  gui_texture->name    = name;
-  gui_texture->texture = texture;
+    if ((unsigned char) *symbol >= ' ')
+    {
+      fputc(*symbol, file);
+    }
+  }
 
-  return gui_texture;
+  fputc('"', file);
 }
 
 /*
- * Load texture and add it to gui assets
+ * Write the recorded timings to file as Chrome trace events,
+ * which can be opened in chrome://tracing or Perfetto
  */
-int gui_texture_load(gui_t* gui, gui_asset_t asset)
+int gui_profile_dump(gui_t* gui, const char* filepath)
 {
-  char* name     = asset.name;
-  char* filepath = asset.filepath;
-
-  if (!gui || !name || !filepath)
+  if (!gui || !filepath)
   {
     return 1;
   }
 
-  SDL_Renderer* renderer = gui->renderer;
-
-  SDL_Texture* texture = sdl_texture_load(renderer, filepath);
+  FILE* file = fopen(filepath, "w");
 
-  if (!texture)
+  if (!file)
   {
+    fprintf(stderr, "fopen: %s: %s\n", filepath, strerror(errno));
+
     return 2;
   }
 
-  gui_assets_t* assets = gui->assets;
-
-  if (!assets)
-  {
-    sdl_texture_destroy(&texture);
+  gui_profile_t* profile = &gui->profile;
 
-    return 3;
-  }
+  fprintf(file, "{\"traceEvents\":[");
 
-  gui_texture_t* gui_texture = gui_texture_create(name, texture);
+  size_t first = (profile->head + GUI_PROFILE_CAPACITY - profile->count) % GUI_PROFILE_CAPACITY;
 
-  if (!gui_texture)
+  for (size_t index = 0; index < profile->count; index++)
   {
-    sdl_texture_destroy(&texture);
+    gui_profile_entry_t* entry = &profile->entries[(first + index) % GUI_PROFILE_CAPACITY];
 
-    return 4;
-  }
+    fprintf(file, "%s\n{\"name\":", (index > 0) ? "," : "");
 
-  gui_texture_t** temp_textures = realloc(assets->textures, sizeof(gui_texture_t*) * (assets->texture_count + 1));
+    gui_profile_string_write(file, entry->name);
 
-  if (!temp_textures)
-  {
-    sdl_texture_destroy(&texture);
+    fprintf(file, ",\"cat\":");
 
-    free(gui_texture);
+    gui_profile_string_write(file, entry->category);
 
-    return 4;
+    fprintf(file, ",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":1}",
+      (unsigned long long) entry->start_us, (unsigned long long) entry->duration_us);
   }
 
-  assets->textures = temp_textures;
+  fprintf(file, "\n]}\n");
 
-  assets->textures[assets->texture_count++] = gui_texture;
+  fclose(file);
 
   return 0;
 }
 
 /*
- * Load textures and add them to gui assets
+ * Set file that the timings are written to when the gui is destroyed
  */
-int gui_textures_load(gui_t* gui, gui_asset_t* assets, size_t count)
+void gui_profile_exit_dump_set(gui_t* gui, const char* filepath)
 {
-  if (!gui || !assets)
+  if (!gui) return;
+
+  gui->profile.exit_path = filepath;
+}
+
+/*
+ * Write timings if an exit file is set, and free them
+ */
+static inline void gui_profile_free(gui_t* gui)
+{
+  if (gui->profile.exit_path)
   {
-    return 1;
+    gui_profile_dump(gui, gui->profile.exit_path);
   }
 
-  for (size_t index = 0; index < count; index++)
-  {
-    if (gui_texture_load(gui, assets[index]) != 0)
-    {
-      return 2;
-    }
-  }
+  free(gui->profile.entries);
 
-  return 0;
+  gui->profile = (gui_profile_t) { 0 };
 }
 
+#else // GUI_PROFILE
+
 /*
- * Create gui_chunk (This is an internal function)
+ * Without GUI_PROFILE, the probes compile to nothing
  */
-static inline gui_chunk_t* gui_chunk_create(char* name, Mix_Chunk* chunk)
+#define GUI_PROFILE_BEGIN(variable)
+#define GUI_PROFILE_END(gui, variable, name, category)
+
+int gui_profile_dump(gui_t* gui, const char* filepath)
 {
-  gui_chunk_t* gui_chunk = malloc(sizeof(gui_chunk_t));
+  (void) gui;
+  (void) filepath;
 
-  if (!gui_chunk)
-  {
-    return NULL;
-  }
+  fprintf(stderr, "gui_profile_dump: compiled without GUI_PROFILE\n");
 
-  gui_chunk->name  = name;
-  gui_chunk->chunk = chunk;
+  return 1;
+}
 
-  return gui_chunk;
+void gui_profile_exit_dump_set(gui_t* gui, const char* filepath)
+{
+  (void) gui;
+  (void) filepath;
+}
+
+static inline void gui_profile_free(gui_t* gui)
+{
+  (void) gui;
 }
 
+#endif // GUI_PROFILE
+
 /*
- * Load chunk and add it to gui assets
+ * Render state
  */
-int gui_chunk_load(gui_t* gui, gui_asset_t asset)
+
+/*
+ * Switch target texture of renderer, if it isn't already the target
+ *
+ * The target is not changed back after rendering,
+ * so consecutive renders to the same target need no switch
+ */
+static inline int gui_target_switch(gui_t* gui, SDL_Texture* target)
 {
-  char* name     = asset.name;
-  char* filepath = asset.filepath;
+  gui_render_state_t* state = &gui->render_state;
 
-  if (!gui || !name || !filepath)
+  if (state->is_target_known && state->target == target)
   {
-    return 1;
-  }
+    gui->stats.target_switch_avoided_count++;
 
-  Mix_Chunk* chunk = mix_chunk_load(filepath);
+    return 0;
+  }
 
-  if (!chunk)
+  if (sdl_target_set(gui->renderer, target) != 0)
   {
-    return 2;
+    state->is_target_known = false;
+
+    return 1;
   }
 
-  gui_assets_t* assets = gui->assets;
+  state->target          = target;
+  state->is_target_known = true;
 
-  if (!assets)
-  {
-    mix_chunk_destroy(&chunk);
+  gui->stats.target_switch_count++;
 
-    return 3;
-  }
+  return 0;
+}
 
-  gui_chunk_t* gui_chunk = gui_chunk_create(name, chunk);
+/*
+ * Set draw color of renderer, if it isn't already the draw color
+ */
+static inline int gui_draw_color_set(gui_t* gui, SDL_Color color)
+{
+  gui_render_state_t* state = &gui->render_state;
 
-  if (!gui_chunk)
+  if (state->is_color_known &&
+      state->color.r == color.r && state->color.g == color.g &&
+      state->color.b == color.b && state->color.a == color.a)
   {
-    mix_chunk_destroy(&chunk);
-
-    return 4;
+    return 0;
   }
 
-  gui_chunk_t** temp_chunks = realloc(assets->chunks, sizeof(gui_chunk_t*) * (assets->chunk_count + 1));
-
-  if (!temp_chunks)
+  if (SDL_SetRenderDrawColor(gui->renderer, color.r, color.g, color.b, color.a) != 0)
   {
-    mix_chunk_destroy(&chunk);
+    fprintf(stderr, "SDL_SetRenderDrawColor: %s\n", SDL_GetError());
 
-    free(gui_chunk);
+    state->is_color_known = false;
 
-    return 4;
+    return 1;
   }
 
-  assets->chunks = temp_chunks;
-
-  assets->chunks[assets->chunk_count++] = gui_chunk;
+  state->color          = color;
+  state->is_color_known = true;
 
   return 0;
 }
 
 /*
- * Load chunks and add them to gui assets
+ * Draw the batched sprites with one call
  */
-int gui_chunks_load(gui_t* gui, gui_asset_t* assets, size_t count)
+static inline int gui_sprite_batch_flush(gui_t* gui)
 {
-  if (!gui || !assets)
+  gui_sprite_batch_t* batch = &gui->sprite_batch;
+
+  if (batch->count == 0) return 0;
+
+  int count = batch->count;
+
+  batch->count = 0;
+
+  if (gui_target_switch(gui, batch->target) != 0)
   {
     return 1;
   }
 
-  for (size_t index = 0; index < count; index++)
+  gui->stats.draw_call_count++;
+
+  if (sdl_geometry_render(gui->renderer, batch->texture, batch->vertices, count * 4, batch->indices, count * 6) != 0)
   {
-    if (gui_chunk_load(gui, assets[index]) != 0)
-    {
-      return 2;
-    }
+    return 2;
   }
 
   return 0;
 }
 
 /*
- * Create gui_font (This is an internal function)
+ * Make room for count sprites in sprite batch
  */
-static inline gui_font_t* gui_font_create(char* name, TTF_Font* font)
+static inline int gui_sprite_batch_reserve(gui_sprite_batch_t* batch, size_t count)
 {
-  gui_font_t* gui_font = malloc(sizeof(gui_font_t));
+  if (count <= batch->capacity) return 0;
 
-  if (!gui_font)
+  size_t capacity = MAX(count, batch->capacity * 2);
+
+  SDL_Vertex* vertices = realloc(batch->vertices, sizeof(SDL_Vertex) * capacity * 4);
+
+  if (!vertices)
   {
-    return NULL;
+    return 1;
   }
 
-  gui_font->name = name;
-  gui_font->font = font;
+  batch->vertices = vertices;
 
-  return gui_font;
+  int* indices = realloc(batch->indices, sizeof(int) * capacity * 6);
+
+  if (!indices)
+  {
+    return 2;
+  }
+
+  batch->indices  = indices;
+  batch->capacity = capacity;
+
+  return 0;
 }
 
 /*
- * Load font and add it to gui assets
+ * Free sprite batch
  */
-int gui_font_load(gui_t* gui, gui_asset_t asset)
+static inline void gui_sprite_batch_free(gui_sprite_batch_t* batch)
 {
-  char* name     = asset.name;
-  char* filepath = asset.filepath;
+  free(batch->vertices);
+  free(batch->indices);
 
-  if (!gui || !name || !filepath)
+  memset(batch, 0, sizeof(gui_sprite_batch_t));
+}
+
+/*
+ * Draw the batched rects with one call
+ */
+static inline int gui_rect_batch_flush(gui_t* gui)
+{
+  gui_rect_batch_t* batch = &gui->rect_batch;
+
+  if (batch->count == 0) return 0;
+
+  int count = batch->count;
+
+  batch->count  = 0;
+  batch->bounds = (SDL_Rect) { 0 };
+
+  if (gui_target_switch(gui, batch->target) != 0)
   {
     return 1;
   }
 
-  TTF_Font* font = ttf_font_load(filepath, 24);
-
-  if (!font)
+  if (gui_draw_color_set(gui, batch->color) != 0)
   {
     return 2;
   }
 
-  gui_assets_t* assets = gui->assets;
+  GUI_PROFILE_BEGIN(start_us);
 
-  if (!assets)
-  {
-    ttf_font_destroy(&font);
+  gui->stats.draw_call_count++;
 
+  if (sdl_rects_render(gui->renderer, batch->rects, count) != 0)
+  {
     return 3;
   }
 
-  gui_font_t* gui_font = gui_font_create(name, font);
-
-  if (!gui_font)
-  {
-    ttf_font_destroy(&font);
+  GUI_PROFILE_END(gui, start_us, "border", "render");
 
-    return 4;
-  }
+  return 0;
+}
 
-  gui_font_t** temp_fonts = realloc(assets->fonts, sizeof(gui_font_t*) * (assets->font_count + 1));
+/*
+ * Append rect to rect batch, if it isn't empty
+ */
+static inline int gui_rect_batch_append(gui_rect_batch_t* batch, SDL_Rect rect)
+{
+  if (rect.w <= 0 || rect.h <= 0) return 0;
 
-  if (!temp_fonts)
+  if (batch->count == batch->capacity)
   {
-    ttf_font_destroy(&font);
+    size_t capacity = MAX(16, batch->capacity * 2);
 
-    free(gui_font);
+    SDL_Rect* rects = realloc(batch->rects, sizeof(SDL_Rect) * capacity);
 
-    return 4;
+    if (!rects)
+    {
+      return 1;
+    }
+
+    batch->rects    = rects;
+    batch->capacity = capacity;
   }
 
-  assets->fonts = temp_fonts;
+  if (batch->count == 0)
+  {
+    batch->bounds = rect;
+  }
+  else SDL_UnionRect(&batch->bounds, &rect, &batch->bounds);
 
-  assets->fonts[assets->font_count++] = gui_font;
+  batch->rects[batch->count++] = rect;
 
   return 0;
 }
 
 /*
- * Load fonts and add them to gui assets
+ * Append the rects of a border around rect to rect batch
+ *
+ * A rounded corner is made of one rect per row of pixels,
+ * and the straight parts of the sides are one rect each
  */
-int gui_fonts_load(gui_t* gui, gui_asset_t* assets, size_t count)
+static inline int gui_rect_batch_border_append(gui_rect_batch_t* batch, gui_border_t border, SDL_Rect rect)
 {
-  if (!gui || !assets)
-  {
-    return 1;
-  }
+  int top, right, bottom, left;
 
-  for (size_t index = 0; index < count; index++)
+  sdl_border_sides_get(border, &top, &right, &bottom, &left);
+
+  SDL_Rect outer = sdl_border_rect_get(border, rect);
+
+  int radius = MAX(0, MIN(border.radius, MIN(outer.w, outer.h) / 2));
+
+  int status = 0;
+
+  for (int row = 0; row < radius; row++)
   {
-    if (gui_font_load(gui, assets[index]) != 0)
+    float dy = radius - row - 0.5f;
+
+    int inset = radius - (int) lroundf(sqrtf(radius * radius - dy * dy));
+
+    int x1 = outer.x + inset;
+    int x2 = outer.x + outer.w - inset;
+
+    // The same row of the top and of the bottom corners
+    int ys[2] = { outer.y + row, outer.y + outer.h - 1 - row };
+
+    for (int index = 0; index < 2; index++)
     {
-      return 2;
+      int y = ys[index];
+
+      if (y < rect.y || y >= rect.y + rect.h)
+      {
+        status |= gui_rect_batch_append(batch, (SDL_Rect) { x1, y, x2 - x1, 1 });
+      }
+      else
+      {
+        status |= gui_rect_batch_append(batch, (SDL_Rect) { x1, y, rect.x - x1, 1 });
+        status |= gui_rect_batch_append(batch, (SDL_Rect) { rect.x + rect.w, y, x2 - rect.x - rect.w, 1 });
+      }
     }
   }
 
-  return 0;
+  int y1 = outer.y + radius;
+  int y2 = outer.y + outer.h - radius;
+
+  int side_y1 = MAX(rect.y, y1);
+  int side_y2 = MIN(rect.y + rect.h, y2);
+
+  int bottom_y = MAX(rect.y + rect.h, y1);
+
+  status |= gui_rect_batch_append(batch, (SDL_Rect) { outer.x, y1, outer.w, MIN(rect.y, y2) - y1 });
+  status |= gui_rect_batch_append(batch, (SDL_Rect) { outer.x, bottom_y, outer.w, y2 - bottom_y });
+  status |= gui_rect_batch_append(batch, (SDL_Rect) { outer.x, side_y1, left, side_y2 - side_y1 });
+  status |= gui_rect_batch_append(batch, (SDL_Rect) { rect.x + rect.w, side_y1, right, side_y2 - side_y1 });
+
+  return status;
 }
 
 /*
- * Get loaded texture by name
+ * Free rect batch
  */
-static inline gui_texture_t* gui_texture_get(gui_t* gui, char* name)
+static inline void gui_rect_batch_free(gui_rect_batch_t* batch)
 {
-  gui_assets_t* assets = gui->assets;
+  free(batch->rects);
 
-  for (size_t index = 0; index < assets->texture_count; index++)
-  {
-    gui_texture_t* gui_texture = assets->textures[index];
+  memset(batch, 0, sizeof(gui_rect_batch_t));
+}
 
-    if (strcmp(gui_texture->name, name) == 0)
-    {
-      return gui_texture;
-    }
-  }
+/*
+ * Set target texture of renderer
+ *
+ * Every render goes through here, so the batched sprites and rects
+ * are drawn before anything that could be drawn over them
+ */
+static inline int gui_target_set(gui_t* gui, SDL_Texture* target)
+{
+  gui_sprite_batch_flush(gui);
 
-  return NULL;
+  gui_rect_batch_flush(gui);
+
+  return gui_target_switch(gui, target);
 }
 
 /*
- * Get loaded font by name
+ * Set target texture of renderer, for a copy of source to area of it
+ *
+ * The batched rects are kept if the copy neither overlaps them nor
+ * reads them from source, so that the borders of many windows
+ * are drawn with one call
  */
-static inline gui_font_t* gui_font_get(gui_t* gui, char* name)
+static inline int gui_target_area_set(gui_t* gui, SDL_Texture* target, SDL_Texture* source, SDL_Rect* area)
 {
-  gui_assets_t* assets = gui->assets;
+  gui_rect_batch_t* batch = &gui->rect_batch;
 
-  for (size_t index = 0; index < assets->font_count; index++)
+  if (!area || (batch->count > 0 && batch->target == source) ||
+      (batch->target == target && SDL_HasIntersection(area, &batch->bounds)))
   {
-    gui_font_t* gui_font = assets->fonts[index];
-
-    if (strcmp(gui_font->name, name) == 0)
-    {
-      return gui_font;
-    }
+    return gui_target_set(gui, target);
   }
 
-  return NULL;
+  gui_sprite_batch_flush(gui);
+
+  return gui_target_switch(gui, target);
 }
 
 /*
- * Get loaded chunk by name
+ * Forget texture as target, before it is destroyed
+ *
+ * SDL resets the target when the target texture is destroyed
  */
-static inline gui_chunk_t* gui_chunk_get(gui_t* gui, char* name)
+static inline void gui_target_forget(gui_t* gui, SDL_Texture* texture)
 {
-  gui_assets_t* assets = gui->assets;
+  gui_render_state_t* state = &gui->render_state;
 
-  for (size_t index = 0; index < assets->chunk_count; index++)
+  if (texture && state->target == texture)
   {
-    gui_chunk_t* gui_chunk = assets->chunks[index];
+    state->target = NULL;
+  }
 
-    if (strcmp(gui_chunk->name, name) == 0)
-    {
-      return gui_chunk;
-    }
+  // Sprites and rects batched for a destroyed target are never drawn
+  if (texture && gui->sprite_batch.target == texture)
+  {
+    gui->sprite_batch.count = 0;
   }
 
-  return NULL;
+  if (texture && gui->rect_batch.target == texture)
+  {
+    gui->rect_batch.count = 0;
+  }
 }
 
 /*
- * Chunk
- */
-
-/*
- * Play loaded chunk
+ * Clear the supplied texture
  */
-int gui_chunk_play(gui_t* gui, char* name)
+static inline int gui_target_clear(gui_t* gui, SDL_Texture* target)
 {
-  if (!gui || !name)
+  if (gui_target_set(gui, target) != 0)
   {
     return 1;
   }
 
-  gui_chunk_t* chunk = gui_chunk_get(gui, name);
-
-  if (!chunk)
+  if (gui_draw_color_set(gui, (SDL_Color) { 0, 0, 0, 255 }) != 0)
   {
     return 2;
   }
 
-  if (mix_chunk_play(chunk->chunk) != 0)
-  {
-    return 3;
-  }
+  SDL_RenderClear(gui->renderer);
 
   return 0;
 }
 
 /*
- * Font
+ * Round side of render target up to its bucket
+ *
+ * The step grows with the side, so that a large target
+ * is at most a quarter larger than needed
  */
+static inline int gui_target_bucket_get(int side)
+{
+  int step = GUI_TARGET_BUCKET_SIZE;
+
+  while (step * 8 < side)
+  {
+    step *= 2;
+  }
+
+  return (side + step - 1) / step * step;
+}
 
 /*
- * Get texture of text
+ * Get the size of the render target, for an area of width and height
  *
- * Maybe: replace with gui_text_t text 
+ * The null backend gives every target 1x1 pixels,
+ * so rendering costs no pixel work, but the layout is kept
  */
-static inline SDL_Texture* sdl_text_texture_create(SDL_Renderer* renderer, const char* text, TTF_Font* font, SDL_Color color)
+static inline void gui_target_size_get(gui_t* gui, int* width, int* height)
 {
-  SDL_Surface* surface = TTF_RenderText_Solid(font, text, color);
-
-  if (!surface)
+  if (gui->backend == GUI_BACKEND_NULL)
   {
-    return NULL;
+    *width  = 1;
+    *height = 1;
   }
+  else
+  {
+    *width  = gui_target_bucket_get(*width);
+    *height = gui_target_bucket_get(*height);
+  }
+}
 
-  SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+/*
+ * Take render target of width and height out of the pool
+ */
+static inline SDL_Texture* gui_target_pool_take(gui_target_pool_t* pool, int width, int height)
+{
+  for (size_t index = 0; index < pool->count; index++)
+  {
+    SDL_Texture* texture = pool->textures[index];
 
-  SDL_FreeSurface(surface);
+    int texture_w;
+    int texture_h;
 
-  if (!texture)
-  {
-    fprintf(stderr, "SDL_CreateTextureFromSurface: %s\n", SDL_GetError());
+    if (SDL_QueryTexture(texture, NULL, NULL, &texture_w, &texture_h) == 0 &&
+        texture_w == width && texture_h == height)
+    {
+      memmove(&pool->textures[index], &pool->textures[index + 1], sizeof(SDL_Texture*) * (pool->count - index - 1));
 
-    return NULL;
+      pool->count--;
+
+      return texture;
+    }
   }
 
-  return texture;
+  return NULL;
 }
 
 /*
- * Get width and height of text
+ * Destroy the render targets in the pool
  */
-static inline int sdl_text_w_and_h_get(int* w, int* h, const char* text, TTF_Font* font)
+static inline void gui_target_pool_free(gui_t* gui)
 {
-  SDL_Surface* surface = TTF_RenderText_Solid(font, text, (SDL_Color) { 0 });
+  gui_target_pool_t* pool = &gui->target_pool;
 
-  if (!surface)
+  for (size_t index = 0; index < pool->count; index++)
   {
-    fprintf(stderr, "TTF_RenderText_Solid: %s\n", TTF_GetError());
+    gui->target_bytes -= sdl_texture_bytes_get(pool->textures[index]);
 
-    return 1;
+    sdl_texture_destroy(&pool->textures[index]);
   }
 
-  *w = surface->w;
-  *h = surface->h;
-
-  SDL_FreeSurface(surface);
-
-  return 0;
+  pool->count = 0;
 }
 
 /*
- * Get width and height of texture
+ * Create texture that windows and menus render to
+ *
+ * The texture is rounded up to its size bucket, so only the top left
+ * width and height of it is used. A recycled texture is cleared
  */
-static inline int gui_texture_w_and_h_get(int* w, int* h, SDL_Texture* texture)
+static inline SDL_Texture* gui_target_texture_create(gui_t* gui, int width, int height)
 {
-  if (SDL_QueryTexture(texture, NULL, NULL, w, h) != 0)
-  {
-    fprintf(stderr, "SDL_QueryTexture: %s\n", SDL_GetError());
+  gui_target_size_get(gui, &width, &height);
 
-    return 1;
-  }
+  SDL_Texture* texture = gui_target_pool_take(&gui->target_pool, width, height);
 
-  return 0;
-}
+  if (texture)
+  {
+    gui->stats.target_reuse_count++;
 
-/*
- * Window
- */
+    gui_target_clear(gui, texture);
 
-/*
- * Get the absolute pixel size from gui_size
- * in case of relative size, parent_size is used in relation
- */
-static inline int gui_size_abs_get(int parent_size, gui_size_t gui_size)
-{
-  switch (gui_size.type)
-  {
-    case GUI_SIZE_REL:
-      return parent_size * gui_size.value.rel;
+    return texture;
+  }
 
-    case GUI_SIZE_ABS:
-      return gui_size.value.abs;
+  texture = sdl_texture_create(gui->renderer, width, height);
 
-    case GUI_SIZE_MAX:
-      return parent_size;
+  if (texture)
+  {
+    gui->target_bytes += sdl_texture_bytes_get(texture);
 
-    default: case GUI_SIZE_NONE:
-      return 0;
+    gui->stats.target_create_count++;
   }
+
+  return texture;
 }
 
 /*
+ * Give texture that windows and menus render to back to the pool
  *
+ * The oldest texture in the pool is destroyed, if it is full
  */
-static inline int sdl_rect_x_get(gui_pos_t pos, int left_width, int right_width, int parent_width, int w)
+static inline void gui_target_texture_destroy(gui_t* gui, SDL_Texture** texture)
 {
-  switch (pos)
-  {
-    case GUI_POS_LEFT:
-      return left_width;
+  if (!texture || !(*texture)) return;
 
-    case GUI_POS_RIGHT:
-      return parent_width - w - right_width;
+  gui_target_forget(gui, *texture);
 
-    default: case GUI_POS_CENTER:
-      return (float) (parent_width - w) / 2.f;
-  }
-}
+  gui_target_pool_t* pool = &gui->target_pool;
 
-/*
- *
- */
-static inline int sdl_rect_y_get(gui_pos_t pos, int top_height, int bottom_height, int parent_height, int h)
-{
-  switch (pos)
+  if (pool->count == GUI_TARGET_POOL_COUNT)
   {
-    case GUI_POS_TOP:
-      return top_height;
+    gui->target_bytes -= sdl_texture_bytes_get(pool->textures[0]);
 
-    case GUI_POS_BOTTOM:
-      return parent_height - h - bottom_height;
+    sdl_texture_destroy(&pool->textures[0]);
 
-    default: case GUI_POS_CENTER:
-      return (float) (parent_height - h) / 2.f;
+    memmove(&pool->textures[0], &pool->textures[1], sizeof(SDL_Texture*) * (pool->count - 1));
+
+    pool->count--;
   }
-}
 
-/*
- *
- */
-static inline int sdl_rect_w_get(int left_width, int right_width, int parent_width, gui_size_t width)
-{
-  int abs_width = gui_size_abs_get(parent_width, width);
+  pool->textures[pool->count++] = *texture;
 
-  return MIN(parent_width - left_width - right_width, abs_width);
+  *texture = NULL;
 }
 
 /*
- *
+ * Free texture that windows and menus render to, without pooling it
  */
-static inline int sdl_rect_h_get(int top_height, int bottom_height, int parent_height, gui_size_t height)
+static inline void gui_target_texture_free(gui_t* gui, SDL_Texture** texture)
 {
-  int abs_height = gui_size_abs_get(parent_height, height);
+  if (!texture || !(*texture)) return;
 
-  return  MIN(parent_height - top_height - bottom_height, abs_height);
+  gui_target_forget(gui, *texture);
+
+  gui->target_bytes -= sdl_texture_bytes_get(*texture);
+
+  sdl_texture_destroy(texture);
 }
 
 /*
- * Create SDL Rect from gui_rect,
- * with the help of parent width and height and aspect ratio
+ * Resize texture that windows and menus render to
+ *
+ * The texture is kept, if the new size is in the same bucket.
+ * Either way the texture is cleared, like a recycled one
  */
-static inline SDL_Rect sdl_rect_create(gui_rect_t gui_rect, int parent_width, int parent_height)
+static inline int gui_target_texture_resize(gui_t* gui, SDL_Texture** texture, int width, int height)
 {
-  int left_width    = gui_size_abs_get(parent_width,  gui_rect.left);
-  int right_width   = gui_size_abs_get(parent_width,  gui_rect.right);
-  int top_height    = gui_size_abs_get(parent_height, gui_rect.top);
-  int bottom_height = gui_size_abs_get(parent_height, gui_rect.bottom);
+  int target_w = width;
+  int target_h = height;
 
-  int w = sdl_rect_w_get(left_width, right_width, parent_width, gui_rect.width);
+  gui_target_size_get(gui, &target_w, &target_h);
 
-  int h = sdl_rect_h_get(top_height, bottom_height, parent_height, gui_rect.height);
+  int texture_w;
+  int texture_h;
 
-  if (gui_rect.aspect_ratio)
+  if (*texture && SDL_QueryTexture(*texture, NULL, NULL, &texture_w, &texture_h) == 0 &&
+      texture_w == target_w && texture_h == target_h)
   {
-    if (gui_rect.width.type == GUI_SIZE_NONE)
-    {
-      w = (float) h * gui_rect.aspect_ratio;
-    }
-    else if (gui_rect.height.type == GUI_SIZE_NONE)
-    {
-      h = (float) w / gui_rect.aspect_ratio;
-    }
+    gui->stats.target_reuse_count++;
+
+    return gui_target_clear(gui, *texture);
   }
 
-  int x = sdl_rect_x_get(gui_rect.xpos, left_width, right_width, parent_width, w);
+  // The old texture is pooled first, so another window can reuse it
+  gui_target_texture_destroy(gui, texture);
 
-  int y = sdl_rect_y_get(gui_rect.ypos, top_height, bottom_height, parent_height, h);
+  *texture = gui_target_texture_create(gui, width, height);
 
-  return (SDL_Rect) {x, y, w, h};
+  return *texture ? 0 : 1;
 }
 
 /*
- * Only destroy window (This is an internal function)
+ * Render a border around rect to target texture
+ *
+ * The border is batched with the previous border,
+ * if it has the same color and target
  */
-static inline void _gui_window_destroy(gui_window_t** window)
+static inline int gui_target_border_render(gui_t* gui, SDL_Texture* target, gui_border_t border, SDL_Rect rect)
 {
-  if (!window || !(*window)) return;
+  int top, right, bottom, left;
 
-  for (size_t index = 0; index < (*window)->child_count; index++)
+  sdl_border_sides_get(border, &top, &right, &bottom, &left);
+
+  if (top <= 0 && right <= 0 && bottom <= 0 && left <= 0)
   {
-    _gui_window_destroy(&(*window)->children[index]);
+    return 0;
   }
 
-  free((*window)->children);
+  SDL_Color color = sdl_color_create(border.color);
 
-  sdl_texture_destroy(&(*window)->texture);
+  color.a = border.opacity;
 
-  free(*window);
+  gui_sprite_batch_flush(gui);
 
-  *window = NULL;
-}
+  gui_rect_batch_t* batch = &gui->rect_batch;
 
-/*
- * Get menu window by name
- */
-static inline gui_window_t* gui_menu_window_get(gui_menu_t* menu, const char* name)
-{
-  if (!menu || !name)
+  if (batch->count > 0 &&
+      (batch->target != target ||
+       batch->color.r != color.r || batch->color.g != color.g ||
+       batch->color.b != color.b || batch->color.a != color.a))
   {
-    return NULL;
+    gui_rect_batch_flush(gui);
   }
 
-  for (ssize_t index = 0; index < menu->window_count; index++)
+  if (batch->count > 0)
   {
-    gui_window_t* window = menu->windows[index];
-
-    if (window && strcmp(window->name, name) == 0)
-    {
-      return window;
-    }
+    gui->stats.border_batched_count++;
   }
 
-  return NULL;
-}
-
-/*
- * Get index of menu window by name
- */
-static inline ssize_t gui_menu_window_index_get(gui_menu_t* menu, const char* name)
-{
-  if (!menu || !name)
-  {
-    return -1;
-  }
+  batch->target = target;
+  batch->color  = color;
 
-  for (ssize_t index = 0; index < menu->window_count; index++)
+  if (gui_rect_batch_border_append(batch, border, rect) != 0)
   {
-    gui_window_t* window = menu->windows[index];
-
-    if (window && strcmp(window->name, name) == 0)
-    {
-      return index;
-    }
+    return 1;
   }
 
-  return -1;
+  return 0;
 }
 
 /*
- * Get index of window child by name
+ * Render texture to target texture
  */
-static inline ssize_t gui_window_child_index_get(gui_window_t* window, const char* name)
+static inline int gui_target_texture_render(gui_t* gui, SDL_Texture* target, SDL_Texture* texture, SDL_Rect* rect)
 {
-  if (!window || !name)
+  if (gui_target_set(gui, target) != 0)
   {
-    return -1;
+    return 1;
   }
 
-  for (ssize_t index = 0; index < window->child_count; index++)
-  {
-    gui_window_t* child = window->children[index];
+  gui->stats.draw_call_count++;
 
-    if (child && strcmp(child->name, name) == 0)
-    {
-      return index;
-    }
+  if (sdl_texture_render(gui->renderer, texture, rect) != 0)
+  {
+    return 2;
   }
 
-  return -1;
+  return 0;
 }
 
 /*
- * Get window child by name
+ * Render loaded texture to target texture
+ *
+ * Packed textures are batched with the previous sprite,
+ * if it is from the same page to the same target
  */
-static inline gui_window_t* gui_window_child_get(gui_window_t* window, const char* name)
+static inline int gui_target_sprite_render(gui_t* gui, SDL_Texture* target, gui_texture_t* texture, SDL_Rect* rect)
 {
-  if (!window || !name)
+  gui_atlas_page_t* page = texture->page;
+
+  if (!page)
   {
-    return NULL;
+    return gui_target_texture_render(gui, target, texture->texture, rect);
   }
 
-  for (ssize_t index = 0; index < window->child_count; index++)
-  {
-    gui_window_t* child = window->children[index];
+  gui_rect_batch_flush(gui);
 
-    if (child && strcmp(child->name, name) == 0)
-    {
-      return child;
-    }
-  }
+  gui_sprite_batch_t* batch = &gui->sprite_batch;
 
-  return NULL;
-}
+  if (batch->count > 0 && (batch->target != target || batch->texture != texture->texture))
+  {
+    gui_sprite_batch_flush(gui);
+  }
 
-/*
- * Remove child from window and destroy it
- */
-int gui_window_child_destroy(gui_window_t* window, char* name)
-{
-  if (!window || !name)
+  if (gui_sprite_batch_reserve(batch, batch->count + 1) != 0)
   {
     return 1;
   }
 
-  ssize_t child_index = gui_window_child_index_get(window, name);
-
-  if (child_index == -1)
+  if (batch->count > 0)
   {
-    return 2;
+    gui->stats.sprite_batched_count++;
   }
 
-  _gui_window_destroy(&window->children[child_index]);
+  batch->target  = target;
+  batch->texture = texture->texture;
 
+  float x1 = rect->x;
+  float y1 = rect->y;
+  float x2 = rect->x + rect->w;
+  float y2 = rect->y + rect->h;
 
-  for (size_t index = child_index; index < (window->child_count - 1); index++)
-  {
-    window->children[index] = window->children[index + 1];
-  }
+  float u1 = (float) texture->rect.x / page->width;
+  float v1 = (float) texture->rect.y / page->height;
+  float u2 = (float) (texture->rect.x + texture->rect.w) / page->width;
+  float v2 = (float) (texture->rect.y + texture->rect.h) / page->height;
 
+  SDL_Color color = { 255, 255, 255, 255 };
 
-  gui_window_t** temp_children = realloc(window->children, sizeof(gui_window_t*) * (window->child_count - 1));
+  SDL_Vertex* vertex = &batch->vertices[batch->count * 4];
 
-  if (!temp_children)
-  {
-    // Here, the child is destroyed, but the children array isn't shrunk
-    return 3;
-  }
+  vertex[0] = (SDL_Vertex) { { x1, y1 }, color, { u1, v1 } };
+  vertex[1] = (SDL_Vertex) { { x2, y1 }, color, { u2, v1 } };
+  vertex[2] = (SDL_Vertex) { { x2, y2 }, color, { u2, v2 } };
+  vertex[3] = (SDL_Vertex) { { x1, y2 }, color, { u1, v2 } };
 
-  window->children = temp_children;
+  int* index = &batch->indices[batch->count * 6];
+  int  first = batch->count * 4;
+
+  index[0] = first + 0;
+  index[1] = first + 1;
+  index[2] = first + 2;
+  index[3] = first + 0;
+  index[4] = first + 2;
+  index[5] = first + 3;
+
+  batch->count++;
 
   return 0;
 }
 
 /*
- * Render loaded texture (name) to window texture
+ * Render the used part of render target texture, to target texture
  */
-int gui_window_texture_render(gui_window_t* window, char* name, gui_rect_t gui_rect)
+static inline int gui_target_part_render(gui_t* gui, SDL_Texture* target, SDL_Texture* texture, int width, int height, SDL_Rect* rect)
 {
-  if (!window || !name)
+  if (gui_target_area_set(gui, target, texture, rect) != 0)
   {
     return 1;
   }
 
-  gui_t* gui = window->gui;
-
-  if (!gui)
-  {
-    return 2;
-  }
+  SDL_Rect part = { 0, 0, width, height };
 
-  SDL_Renderer* renderer = gui->renderer;
+  gui->stats.draw_call_count++;
 
-  if (!renderer)
-  {
-    return 3;
-  }
+  // The targets of the null backend are 1x1, and used as a whole
+  SDL_Rect* source = (gui->backend == GUI_BACKEND_NULL) ? NULL : &part;
 
-  gui_texture_t* gui_texture = gui_texture_get(gui, name);
-  
-  if (!gui_texture)
+  if (SDL_RenderCopy(gui->renderer, texture, source, rect) != 0)
   {
-    return 4;
-  }
-
-  SDL_Rect sdl_rect = sdl_rect_create(gui_rect, window->sdl_rect.w, window->sdl_rect.h);
+    fprintf(stderr, "SDL_RenderCopy: %s\n", SDL_GetError());
 
-  if (sdl_target_texture_render(renderer, window->texture, gui_texture->texture, &sdl_rect) != 0)
-  {
-    return 5;
+    return 2;
   }
 
   return 0;
 }
 
 /*
- *
+ * Render geometry with texture to target texture
  */
-static inline int gui_window_text_render(gui_window_t* window, gui_text_t text, gui_rect_t gui_rect)
+static inline int gui_target_geometry_render(gui_t* gui, SDL_Texture* target, SDL_Texture* texture, SDL_Vertex* vertices, int vertex_count, int* indices, int index_count)
 {
-  if (!window || !text.text || !text.font)
+  if (gui_target_set(gui, target) != 0)
   {
     return 1;
   }
 
-  gui_t* gui = window->gui;
+  gui->stats.draw_call_count++;
 
-  if (!gui)
+  if (sdl_geometry_render(gui->renderer, texture, vertices, vertex_count, indices, index_count) != 0)
   {
     return 2;
   }
 
-  SDL_Renderer* renderer = gui->renderer;
+  return 0;
+}
 
-  if (!renderer)
-  {
-    return 3;
-  }
+/*
+ * Name index
+ */
 
-  gui_font_t* gui_font = gui_font_get(gui, text.font);
-  
-  if (!gui_font)
-  {
-    return 4;
-  }
-
-  SDL_Color sdl_color = sdl_color_create(text.color);
-
-  SDL_Texture* texture = sdl_text_texture_create(renderer, text.text, gui_font->font, sdl_color);
-
-  if (!texture)
-  {
-    return 5;
-  }
+/*
+ * Hash name in name index
+ */
+static inline uint32_t gui_name_hash(const char* name)
+{
+  return gui_string_hash(2166136261u, name);
+}
 
-  int textw;
-  int texth;
+/*
+ * Get slot of name in name index, or the empty slot where it belongs
+ */
+static inline gui_name_slot_t* gui_name_index_slot_get(gui_name_index_t* index, const char* name, uint32_t hash)
+{
+  size_t mask = index->capacity - 1;
 
-  if (sdl_text_w_and_h_get(&textw, &texth, text.text, gui_font->font) != 0)
+  for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
   {
-    fprintf(stderr, "sdl_text_w_and_h_get: %s\n", strerror(errno));
+    gui_name_slot_t* name_slot = &index->slots[slot];
 
-    sdl_texture_destroy(&texture);
+    if (!name_slot->name)
+    {
+      return name_slot;
+    }
 
-    return 6;
+    if (name_slot->hash == hash && strcmp(name_slot->name, name) == 0)
+    {
+      return name_slot;
+    }
   }
+}
 
-  gui_rect.aspect_ratio = (float) textw / (float) texth;
-
-  SDL_Rect sdl_rect = sdl_rect_create(gui_rect, window->sdl_rect.w, window->sdl_rect.h);
-  
-  if (sdl_target_texture_render(renderer, window->texture, texture, &sdl_rect) != 0)
+/*
+ * Get index of named item, -1 if it doesn't exist
+ */
+static inline ssize_t gui_name_index_get(gui_name_index_t* index, const char* name)
+{
+  if (index->count == 0)
   {
-    sdl_texture_destroy(&texture);
-
-    return 5;
+    return -1;
   }
 
-  sdl_texture_destroy(&texture);
+  gui_name_slot_t* slot = gui_name_index_slot_get(index, name, gui_name_hash(name));
 
-  return 0;
+  return slot->name ? (ssize_t) slot->index : -1;
 }
 
 /*
- *
+ * Double the capacity of name index and rehash the slots
  */
-static inline int gui_menu_text_render(gui_menu_t* menu, gui_text_t text, gui_rect_t gui_rect)
+static inline int gui_name_index_grow(gui_name_index_t* index)
 {
-  if (!menu || !text.text || !text.font)
+  gui_name_index_t new_index =
   {
-    return 1;
-  }
-
-  gui_t* gui = menu->gui;
-
-  if (!gui)
-  {
-    return 2;
-  }
+    .capacity = index->capacity ? index->capacity * 2 : 16,
+    .count    = index->count
+  };
 
-  SDL_Renderer* renderer = gui->renderer;
+  new_index.slots = calloc(new_index.capacity, sizeof(gui_name_slot_t));
 
-  if (!renderer)
+  if (!new_index.slots)
   {
-    return 3;
+    return 1;
   }
 
-  gui_font_t* gui_font = gui_font_get(gui, text.font);
-  
-  if (!gui_font)
+  for (size_t slot = 0; slot < index->capacity; slot++)
   {
-    return 4;
-  }
-
-  SDL_Color sdl_color = sdl_color_create(text.color);
+    gui_name_slot_t* old_slot = &index->slots[slot];
 
-  SDL_Texture* texture = sdl_text_texture_create(renderer, text.text, gui_font->font, sdl_color);
+    if (!old_slot->name) continue;
 
-  if (!texture)
-  {
-    return 5;
+    *gui_name_index_slot_get(&new_index, old_slot->name, old_slot->hash) = *old_slot;
   }
 
-  int textw;
-  int texth;
+  free(index->slots);
 
-  if (sdl_text_w_and_h_get(&textw, &texth, text.text, gui_font->font) != 0)
-  {
-    fprintf(stderr, "sdl_text_w_and_h_get: %s\n", strerror(errno));
+  *index = new_index;
 
-    sdl_texture_destroy(&texture);
+  return 0;
+}
 
-    return 6;
+/*
+ * Add name of item to name index
+ *
+ * If the name already exists, the first item is kept
+ */
+static inline int gui_name_index_add(gui_name_index_t* index, const char* name, size_t item_index)
+{
+  // Keep the load factor below one half
+  if ((index->count + 1) * 2 > index->capacity)
+  {
+    if (gui_name_index_grow(index) != 0)
+    {
+      return 1;
+    }
   }
 
-  gui_rect.aspect_ratio = (float) textw / (float) texth;
+  uint32_t hash = gui_name_hash(name);
 
-  SDL_Rect sdl_rect = sdl_rect_create(gui_rect, gui->width, gui->height);
-  
+  gui_name_slot_t* slot = gui_name_index_slot_get(index, name, hash);
 
-  if (sdl_target_texture_render(renderer, menu->texture, texture, &sdl_rect) != 0)
+  if (!slot->name)
   {
-    sdl_texture_destroy(&texture);
+    *slot = (gui_name_slot_t) { name, hash, item_index };
 
-    return 5;
+    index->count++;
   }
 
-  sdl_texture_destroy(&texture);
-
   return 0;
 }
 
 /*
- * Remove window from menu and destroy it
+ * Assets
  */
-int gui_menu_window_destroy(gui_menu_t* menu, char* name)
-{
-  if (!menu || !name)
-  {
-    return 1;
-  }
 
-  ssize_t window_index = gui_menu_window_index_get(menu, name);
+/*
+ * Create assets struct
+ */
+static inline gui_assets_t* gui_assets_create(void)
+{
+  gui_assets_t* assets = malloc(sizeof(gui_assets_t));
 
-  if (window_index == -1)
+  if (!assets)
   {
-    return 2;
+    return NULL;
   }
 
-  _gui_window_destroy(&menu->windows[window_index]);
+  memset(assets, 0, sizeof(gui_assets_t));
 
+  return assets;
+}
 
-  for (size_t index = window_index; index < (menu->window_count - 1); index++)
+/*
+ * Destroy gui texture
+ */
+static inline void gui_texture_destroy(gui_texture_t** texture)
+{
+  if (!texture || !(*texture)) return;
+
+  // The texture of a packed texture belongs to its page
+  if (!(*texture)->page)
   {
-    menu->windows[index] = menu->windows[index + 1];
+    sdl_texture_destroy(&(*texture)->texture);
   }
 
+  free(*texture);
 
-  gui_window_t** temp_windows = realloc(menu->windows, sizeof(gui_window_t*) * (menu->window_count - 1));
+  *texture = NULL;
+}
 
-  if (!temp_windows)
-  {
-    // Here, the window is destroyed, but the windows array isn't shrunk
-    return 3;
-  }
+/*
+ * Destroy page of texture atlas
+ */
+static inline void gui_atlas_page_destroy(gui_atlas_page_t** page)
+{
+  if (!page || !(*page)) return;
 
-  menu->windows = temp_windows;
+  sdl_texture_destroy(&(*page)->texture);
 
-  return 0;
+  free((*page)->nodes);
+
+  free(*page);
+
+  *page = NULL;
 }
 
 /*
- * Create window and add it to menu
+ * Destroy glyph atlas
  */
-gui_window_t* gui_menu_window_create(gui_menu_t* menu, char* name, gui_rect_t gui_rect, gui_border_t border)
+static inline void gui_glyph_atlas_destroy(gui_glyph_atlas_t** atlas)
 {
-  if (!menu || !name)
-  {
-    return NULL;
-  }
+  if (!atlas || !(*atlas)) return;
 
-  gui_t* gui = menu->gui;
+  sdl_texture_destroy(&(*atlas)->texture);
 
-  if (!gui)
-  {
-    return NULL;
-  }
+  free((*atlas)->vertices);
+  free((*atlas)->indices);
 
-  gui_window_t* window = malloc(sizeof(gui_window_t));
+  free(*atlas);
 
-  if (!window)
-  {
-    return NULL;
-  }
+  *atlas = NULL;
+}
 
-  memset(window, 0, sizeof(gui_window_t));
+/*
+ * Destroy gui font
+ */
+static inline void gui_font_destroy(gui_font_t** font)
+{
+  if (!font || !(*font)) return;
 
-  window->name = name;
-  window->gui  = gui;
+  gui_glyph_atlas_destroy(&(*font)->atlas);
 
-  window->border = border;
+  ttf_font_destroy(&(*font)->font);
 
-  window->is_child = false;
-  window->parent.menu = menu;
+  SDL_free((*font)->data);
 
-  window->gui_rect = gui_rect;
+  free(*font);
 
-  window->sdl_rect = sdl_rect_create(window->gui_rect, gui->width, gui->height);
+  *font = NULL;
+}
 
-  window->texture = sdl_texture_create(gui->renderer, window->sdl_rect.w, window->sdl_rect.h);
+/*
+ * Destroy gui chunk
+ */
+static inline void gui_chunk_destroy(gui_chunk_t** chunk)
+{
+  if (!chunk || !(*chunk)) return;
 
-  if (!window->texture)
-  {
-    free(window);
+  mix_chunk_destroy(&(*chunk)->chunk);
 
-    return NULL;
-  }
+  free(*chunk);
 
+  *chunk = NULL;
+}
 
-  gui_window_t** temp_windows = realloc(menu->windows, sizeof(gui_window_t*) * (menu->window_count + 1));
+/*
+ * Destroy gui music
+ */
+static inline void gui_music_destroy(gui_music_t** music)
+{
+  if (!music || !(*music)) return;
 
-  if (!temp_windows)
-  {
-    _gui_window_destroy(&window);
+  // mix_music_destroy(&(*music)->music);
 
-    return NULL;
-  }
+  free(*music);
 
-  menu->windows = temp_windows;
+  *music = NULL;
+}
 
-  menu->windows[menu->window_count++] = window;
+/*
+ * Release memory of bundle, that was mapped or read by gui_bundle_map
+ */
+static inline void gui_bundle_unmap(void* data, size_t size)
+{
+#ifndef _WIN32
+  munmap(data, size);
+#else // _WIN32
+  (void) size;
 
-  return window;
+  SDL_free(data);
+#endif // _WIN32
 }
 
 /*
- * Create child window and add it to window
+ * Destroy assets struct
  */
-gui_window_t* gui_window_child_create(gui_window_t* window, char* name, gui_rect_t gui_rect)
+static inline void gui_assets_destroy(gui_assets_t** assets)
 {
-  if (!window || !name)
+  if (!assets || !(*assets)) return;
+
+  for (size_t index = 0; index < (*assets)->texture_count; index++)
   {
-    return NULL;
+    gui_texture_destroy(&(*assets)->textures[index]);
   }
 
-  gui_t* gui = window->gui;
+  free((*assets)->textures);
 
-  if (!gui)
+  free((*assets)->texture_index.slots);
+
+
+  for (size_t index = 0; index < (*assets)->font_count; index++)
   {
-    return NULL;
+    gui_font_destroy(&(*assets)->fonts[index]);
   }
 
-  gui_window_t* child = malloc(sizeof(gui_window_t));
+  free((*assets)->fonts);
 
-  if (!child)
+  free((*assets)->font_index.slots);
+
+
+  for (size_t index = 0; index < (*assets)->chunk_count; index++)
   {
-    return NULL;
+    gui_chunk_destroy(&(*assets)->chunks[index]);
   }
 
-  memset(child, 0, sizeof(gui_window_t));
+  free((*assets)->chunks);
 
-  child->name = name;
-  child->gui  = gui;
+  free((*assets)->chunk_index.slots);
 
-  child->is_child = true;
-  child->parent.window = window;
 
-  child->gui_rect = gui_rect;
+  for (size_t index = 0; index < (*assets)->music_count; index++)
+  {
+    gui_music_destroy(&(*assets)->musics[index]);
+  }
 
-  child->sdl_rect = sdl_rect_create(child->gui_rect, window->sdl_rect.w, window->sdl_rect.h);
+  free((*assets)->musics);
 
-  child->texture = sdl_texture_create(gui->renderer, child->sdl_rect.w, child->sdl_rect.h);
 
-  if (!child->texture)
+  for (size_t index = 0; index < (*assets)->page_count; index++)
   {
-    free(child);
-
-    return NULL;
+    gui_atlas_page_destroy(&(*assets)->pages[index]);
   }
 
+  free((*assets)->pages);
 
-  gui_window_t** temp_children = realloc(window->children, sizeof(gui_window_t*) * (window->child_count + 1));
 
-  if (!temp_children)
+  // The bundles are unmapped last, as the assets point into them
+  for (size_t index = 0; index < (*assets)->bundle_count; index++)
   {
-    _gui_window_destroy(&child);
-
-    return NULL;
+    gui_bundle_unmap((*assets)->bundles[index].data, (*assets)->bundles[index].size);
   }
 
-  window->children = temp_children;
+  free((*assets)->bundles);
 
-  window->children[window->child_count++] = child;
 
-  return child;
+  free(*assets);
+
+  *assets = NULL;
 }
 
 /*
- * Render window with all of it's child windows
+ * Add texture to assets
  */
-static inline int gui_window_render(gui_window_t* window)
+static inline int gui_assets_texture_add(gui_assets_t* assets, gui_texture_t* texture)
 {
-  if (!window)
+  gui_texture_t** temp_textures = realloc(assets->textures, sizeof(gui_texture_t*) * (assets->texture_count + 1));
+
+  if (!temp_textures)
   {
     return 1;
   }
 
-  gui_t* gui = window->gui;
+  assets->textures = temp_textures;
 
-  if (!gui)
+  if (gui_name_index_add(&assets->texture_index, texture->name, assets->texture_count) != 0)
   {
     return 2;
   }
 
-  SDL_Renderer* renderer = gui->renderer;
-
-  if (!renderer)
+  if (!texture->page)
   {
-    return 3;
+    texture->bytes = sdl_texture_bytes_get(texture->texture);
+
+    assets->texture_bytes += texture->bytes;
   }
 
-  for (size_t index = 0; index < window->child_count; index++)
+  assets->textures[assets->texture_count++] = texture;
+
+  return 0;
+}
+
+/*
+ * Add font to assets
+ */
+static inline int gui_assets_font_add(gui_assets_t* assets, gui_font_t* font)
+{
+  gui_font_t** temp_fonts = realloc(assets->fonts, sizeof(gui_font_t*) * (assets->font_count + 1));
+
+  if (!temp_fonts)
   {
-    gui_window_t* child = window->children[index];
+    return 1;
+  }
 
-    if (gui_window_render(child) != 0)
-    {
-      return 4;
-    }
+  assets->fonts = temp_fonts;
 
-    if (sdl_target_texture_render(renderer, window->texture, child->texture, &child->sdl_rect) != 0)
-    {
-      return 5;
-    }
+  if (gui_name_index_add(&assets->font_index, font->name, assets->font_count) != 0)
+  {
+    return 2;
   }
 
+  assets->fonts[assets->font_count++] = font;
+
   return 0;
 }
 
 /*
- * Menu
+ * Add chunk to assets
  */
+static inline int gui_assets_chunk_add(gui_assets_t* assets, gui_chunk_t* chunk)
+{
+  gui_chunk_t** temp_chunks = realloc(assets->chunks, sizeof(gui_chunk_t*) * (assets->chunk_count + 1));
+
+  if (!temp_chunks)
+  {
+    return 1;
+  }
+
+  assets->chunks = temp_chunks;
+
+  if (gui_name_index_add(&assets->chunk_index, chunk->name, assets->chunk_count) != 0)
+  {
+    return 2;
+  }
+
+  assets->chunks[assets->chunk_count++] = chunk;
+
+  return 0;
+}
 
 /*
- * Set active menu
+ * Create gui_texture (This is an internal function)
  */
-void gui_active_menu_set(gui_t* gui, char* name)
+static inline gui_texture_t* gui_texture_create(char* name, SDL_Texture* texture)
 {
-  gui->menu_name = name;
+  gui_texture_t* gui_texture = malloc(sizeof(gui_texture_t));
+
+  if (!gui_texture)
+  {
+    return NULL;
+  }
+
+  memset(gui_texture, 0, sizeof(gui_texture_t));
+
+  gui_texture->name    = name;
+  gui_texture->texture = texture;
+
+  return gui_texture;
 }
 
 /*
- * Render menu with all of it's windows and child windows
- *
- * Clear the textures of the windows that are rendered
- *
- * The for-loop decides which order to render the windows
+ * Load texture and add it to gui assets
  */
-static inline int gui_menu_render(gui_menu_t* menu)
+int gui_texture_load(gui_t* gui, gui_asset_t asset)
 {
-  if (!menu)
+  char* name     = asset.name;
+  char* filepath = asset.filepath;
+
+  if (!gui || !name || !filepath)
   {
     return 1;
   }
 
-  gui_t* gui = menu->gui;
+  SDL_Renderer* renderer = gui->renderer;
 
-  if (!gui)
+  SDL_Texture* texture = sdl_texture_load(renderer, filepath);
+
+  if (!texture)
   {
     return 2;
   }
 
-  SDL_Renderer* renderer = gui->renderer;
+  gui_assets_t* assets = gui->assets;
 
-  if (!renderer)
+  if (!assets)
   {
+    sdl_texture_destroy(&texture);
+
     return 3;
   }
 
-  for (size_t index = 0; index < menu->window_count; index++)
+  gui_texture_t* gui_texture = gui_texture_create(name, texture);
+
+  if (!gui_texture)
   {
-    gui_window_t* window = menu->windows[index];
+    sdl_texture_destroy(&texture);
 
-    if (gui_window_render(window) != 0)
-    {
-      return 4;
-    }
+    return 4;
+  }
 
-    if (sdl_target_texture_render(renderer, menu->texture, window->texture, &window->sdl_rect) != 0)
-    {
-      return 5;
-    }
+  if (gui_assets_texture_add(assets, gui_texture) != 0)
+  {
+    sdl_texture_destroy(&texture);
 
-    if (sdl_target_border_render(renderer, menu->texture, window->border, window->sdl_rect) != 0)
-    {
-      return 6;
-    }
+    free(gui_texture);
+
+    return 4;
   }
 
   return 0;
 }
 
 /*
- *
+ * Create gui_chunk (This is an internal function)
  */
-static inline SDL_Texture* gui_window_parent_texture_get(gui_window_t* window)
+static inline gui_chunk_t* gui_chunk_create(char* name, Mix_Chunk* chunk)
 {
-  if (window->is_child)
-  {
-    if (window->parent.window)
-    {
-      return window->parent.window->texture;
-    }
-  }
-  else
+  gui_chunk_t* gui_chunk = malloc(sizeof(gui_chunk_t));
+
+  if (!gui_chunk)
   {
-    if (window->parent.menu)
-    {
-      return window->parent.menu->texture;
-    }
+    return NULL;
   }
 
-  return NULL;
+  gui_chunk->name  = name;
+  gui_chunk->chunk = chunk;
+
+  return gui_chunk;
 }
 
 /*
- * Render border around window
+ * Load chunk and add it to gui assets
  */
-int gui_window_border_render(gui_window_t* window, gui_border_t border)
+int gui_chunk_load(gui_t* gui, gui_asset_t asset)
 {
-  if (!window)
+  char* name     = asset.name;
+  char* filepath = asset.filepath;
+
+  if (!gui || !name || !filepath)
   {
     return 1;
   }
 
-  gui_t* gui = window->gui;
+  Mix_Chunk* chunk = mix_chunk_load(filepath);
 
-  if (!gui)
+  if (!chunk)
   {
     return 2;
   }
 
-  SDL_Renderer* renderer = gui->renderer;
+  gui_assets_t* assets = gui->assets;
 
-  if (!renderer)
+  if (!assets)
   {
+    mix_chunk_destroy(&chunk);
+
     return 3;
   }
 
-  SDL_Texture* texture = gui_window_parent_texture_get(window);
+  gui_chunk_t* gui_chunk = gui_chunk_create(name, chunk);
 
-  if (!texture)
+  if (!gui_chunk)
   {
+    mix_chunk_destroy(&chunk);
+
     return 4;
   }
 
-  if (sdl_target_border_render(renderer, texture, border, window->sdl_rect) != 0)
+  if (gui_assets_chunk_add(assets, gui_chunk) != 0)
   {
-    return 5;
+    mix_chunk_destroy(&chunk);
+
+    free(gui_chunk);
+
+    return 4;
   }
 
   return 0;
 }
 
 /*
- *
+ * Create gui_font (This is an internal function)
  */
-int gui_curr_window_border_render(gui_t* gui, gui_border_t border)
+static inline gui_font_t* gui_font_create(char* name, TTF_Font* font)
 {
-  return gui_window_border_render(gui->curr_window, border);
-}
+  gui_font_t* gui_font = malloc(sizeof(gui_font_t));
 
-/*
- *
- */
-bool gui_window_name_check(gui_window_t* window, char* name)
-{
-  if (!window || !name) return false;
+  if (!gui_font)
+  {
+    return NULL;
+  }
 
-  return (strcmp(window->name, name) == 0);
-}
-/*
- *
- */
-bool gui_curr_window_name_check(gui_t* gui, char* name)
-{
-  if (!gui || !name) return false;
+  gui_font->name  = name;
+  gui_font->font  = font;
+  gui_font->atlas = NULL;
+  gui_font->data  = NULL;
 
-  return gui_window_name_check(gui->curr_window, name);
+  return gui_font;
 }
 
 /*
- * Render loaded texture (name) to menu texture
+ * Load font and add it to gui assets
  */
-int gui_menu_texture_render(gui_menu_t* menu, char* name, gui_rect_t gui_rect)
+int gui_font_load(gui_t* gui, gui_asset_t asset)
 {
-  if (!menu || !name)
+  char* name     = asset.name;
+  char* filepath = asset.filepath;
+
+  if (!gui || !name || !filepath)
   {
     return 1;
   }
 
-  gui_t* gui = menu->gui;
+  TTF_Font* font = ttf_font_load(filepath, 24);
 
-  if (!gui)
+  if (!font)
   {
     return 2;
   }
 
-  SDL_Renderer* renderer = gui->renderer;
+  gui_assets_t* assets = gui->assets;
 
-  if (!renderer)
+  if (!assets)
   {
+    ttf_font_destroy(&font);
+
     return 3;
   }
 
-  gui_texture_t* gui_texture = gui_texture_get(gui, name);
-  
-  if (!gui_texture)
+  gui_font_t* gui_font = gui_font_create(name, font);
+
+  if (!gui_font)
+  {
+    ttf_font_destroy(&font);
+
+    return 4;
+  }
+
+  if (gui_assets_font_add(assets, gui_font) != 0)
   {
+    ttf_font_destroy(&font);
+
+    free(gui_font);
+
     return 4;
   }
 
-  SDL_Rect sdl_rect = sdl_rect_create(gui_rect, gui->width, gui->height);
+  return 0;
+}
+
+/*
+ * Texture atlas
+ */
+
+/*
+ * Get the lowest y where a rect of width and height fits,
+ * with its left edge at the skyline node of index
+ *
+ * -1 is returned if the rect doesn't fit
+ */
+static inline int gui_atlas_page_fit(gui_atlas_page_t* page, size_t index, int width, int height)
+{
+  if (page->nodes[index].x + width > page->width)
+  {
+    return -1;
+  }
+
+  int y = 0;
+
+  for (int remaining = width; remaining > 0; index++)
+  {
+    if (index >= page->node_count)
+    {
+      return -1;
+    }
+
+    y = MAX(y, page->nodes[index].y);
+
+    if (y + height > page->height)
+    {
+      return -1;
+    }
+
+    remaining -= page->nodes[index].width;
+  }
+
+  return y;
+}
+
+/*
+ * Raise the skyline over a newly placed rect
+ */
+static inline void gui_atlas_page_skyline_add(gui_atlas_page_t* page, size_t index, int x, int y, int width)
+{
+  gui_skyline_node_t* nodes = page->nodes;
+
+  memmove(&nodes[index + 1], &nodes[index], sizeof(gui_skyline_node_t) * (page->node_count - index));
+
+  nodes[index] = (gui_skyline_node_t) { x, y, width };
+
+  page->node_count++;
+
+  // Cut the nodes that are now under the new node
+  for (size_t next = index + 1; next < page->node_count; )
+  {
+    int shrink = (nodes[next - 1].x + nodes[next - 1].width) - nodes[next].x;
+
+    if (shrink <= 0) break;
+
+    nodes[next].x     += shrink;
+    nodes[next].width -= shrink;
+
+    if (nodes[next].width > 0) break;
+
+    memmove(&nodes[next], &nodes[next + 1], sizeof(gui_skyline_node_t) * (page->node_count - next - 1));
+
+    page->node_count--;
+  }
+
+  // Merge neighbouring nodes of the same height
+  for (size_t next = 1; next < page->node_count; )
+  {
+    if (nodes[next - 1].y == nodes[next].y)
+    {
+      nodes[next - 1].width += nodes[next].width;
+
+      memmove(&nodes[next], &nodes[next + 1], sizeof(gui_skyline_node_t) * (page->node_count - next - 1));
+
+      page->node_count--;
+    }
+    else next++;
+  }
+}
+
+/*
+ * Find room for a rect of width and height in page
+ */
+static inline int gui_atlas_page_pack(gui_atlas_page_t* page, int width, int height, SDL_Rect* rect)
+{
+  int    best_bottom = INT_MAX;
+  int    best_width  = INT_MAX;
+  size_t best_index  = 0;
+
+  for (size_t index = 0; index < page->node_count; index++)
+  {
+    int y = gui_atlas_page_fit(page, index, width, height);
+
+    if (y == -1) continue;
+
+    // Prefer the lowest bottom edge, and then the narrowest segment
+    if (y + height < best_bottom || (y + height == best_bottom && page->nodes[index].width < best_width))
+    {
+      best_bottom = y + height;
+      best_width  = page->nodes[index].width;
+      best_index  = index;
+    }
+  }
+
+  if (best_bottom == INT_MAX)
+  {
+    return 1;
+  }
+
+  *rect = (SDL_Rect) { page->nodes[best_index].x, best_bottom - height, width, height };
+
+  gui_atlas_page_skyline_add(page, best_index, rect->x, best_bottom, width);
+
+  return 0;
+}
+
+/*
+ * Create empty page of texture atlas
+ */
+static inline gui_atlas_page_t* gui_atlas_page_create(SDL_Renderer* renderer, int width, int height)
+{
+  gui_atlas_page_t* page = malloc(sizeof(gui_atlas_page_t));
+
+  if (!page)
+  {
+    return NULL;
+  }
+
+  memset(page, 0, sizeof(gui_atlas_page_t));
+
+  // The skyline never has more nodes than pixels across the page
+  page->nodes = malloc(sizeof(gui_skyline_node_t) * (width + 1));
+
+  if (!page->nodes)
+  {
+    free(page);
+
+    return NULL;
+  }
+
+  page->texture = sdl_atlas_texture_create(renderer, width, height);
+
+  if (!page->texture)
+  {
+    free(page->nodes);
+
+    free(page);
+
+    return NULL;
+  }
+
+  page->width  = width;
+  page->height = height;
+
+  page->nodes[0]   = (gui_skyline_node_t) { 0, 0, width };
+  page->node_count = 1;
+
+  return page;
+}
+
+/*
+ * Add new page to the texture atlas of assets
+ */
+static inline gui_atlas_page_t* gui_assets_page_add(gui_assets_t* assets, SDL_Renderer* renderer)
+{
+  gui_atlas_page_t** temp_pages = realloc(assets->pages, sizeof(gui_atlas_page_t*) * (assets->page_count + 1));
+
+  if (!temp_pages)
+  {
+    return NULL;
+  }
+
+  assets->pages = temp_pages;
+
+  gui_atlas_page_t* page = gui_atlas_page_create(renderer, GUI_TEXTURE_ATLAS_SIZE, GUI_TEXTURE_ATLAS_SIZE);
+
+  if (!page)
+  {
+    return NULL;
+  }
+
+  assets->pages[assets->page_count++] = page;
+
+  return page;
+}
+
+/*
+ * Pack surface into a page of the texture atlas
+ *
+ * NULL is returned if the surface is too large to be packed
+ */
+static inline gui_texture_t* gui_atlas_texture_create(gui_t* gui, char* name, SDL_Surface* surface)
+{
+  if (surface->w > GUI_TEXTURE_ATLAS_MAX_SIDE || surface->h > GUI_TEXTURE_ATLAS_MAX_SIDE)
+  {
+    return NULL;
+  }
+
+  gui_assets_t* assets = gui->assets;
+
+  int width  = surface->w + GUI_TEXTURE_ATLAS_PADDING;
+  int height = surface->h + GUI_TEXTURE_ATLAS_PADDING;
+
+  gui_atlas_page_t* page = NULL;
+
+  SDL_Rect rect;
+
+  for (size_t index = 0; index < assets->page_count; index++)
+  {
+    if (gui_atlas_page_pack(assets->pages[index], width, height, &rect) == 0)
+    {
+      page = assets->pages[index];
+
+      break;
+    }
+  }
+
+  if (!page)
+  {
+    page = gui_assets_page_add(assets, gui->renderer);
+
+    if (!page || gui_atlas_page_pack(page, width, height, &rect) != 0)
+    {
+      return NULL;
+    }
+  }
+
+  rect.w = surface->w;
+  rect.h = surface->h;
+
+  SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+
+  if (!converted)
+  {
+    fprintf(stderr, "SDL_ConvertSurfaceFormat: %s\n", SDL_GetError());
+
+    return NULL;
+  }
+
+  int status = SDL_UpdateTexture(page->texture, &rect, converted->pixels, converted->pitch);
+
+  SDL_FreeSurface(converted);
+
+  if (status != 0)
+  {
+    fprintf(stderr, "SDL_UpdateTexture: %s\n", SDL_GetError());
+
+    return NULL;
+  }
+
+  gui_texture_t* gui_texture = gui_texture_create(name, page->texture);
+
+  if (!gui_texture)
+  {
+    return NULL;
+  }
+
+  gui_texture->rect = rect;
+  gui_texture->page = page;
+
+  return gui_texture;
+}
+
+/*
+ * Pack textures loaded by gui_textures_load into shared atlas pages
+ *
+ * Consecutive renders of packed textures from the same page,
+ * to the same window or menu, are drawn with one call
+ */
+int gui_texture_atlas_set(gui_t* gui, bool is_packed)
+{
+  if (!gui)
+  {
+    return 1;
+  }
+
+  gui->is_texture_packed = is_packed;
+
+  return 0;
+}
+
+/*
+ * Asset loader
+ */
+
+/*
+ * Kind of asset in a load
+ */
+typedef enum gui_asset_kind_t
+{
+  GUI_ASSET_TEXTURE,
+  GUI_ASSET_FONT,
+  GUI_ASSET_CHUNK
+} gui_asset_kind_t;
+
+/*
+ * Asset that is decoded by a worker, and then uploaded by the render thread
+ */
+typedef struct gui_load_job_t
+{
+  gui_asset_t  asset;
+  SDL_Surface* surface; // Decoded texture
+  void*        data;    // File data of font or chunk
+  size_t       size;
+  SDL_atomic_t is_done;
+} gui_load_job_t;
+
+/*
+ * Load of assets, decoded by a pool of worker threads
+ */
+typedef struct gui_load_t
+{
+  gui_ticket_t     ticket;       // GUI_TICKET_NONE if load is synchronous
+  gui_asset_kind_t kind;
+  gui_load_job_t*  jobs;
+  size_t           job_count;
+  SDL_atomic_t     next_job;     // Next job for a worker to take
+  SDL_sem*         done_sem;     // Posted for every decoded job
+  SDL_Thread**     threads;
+  size_t           thread_count;
+  size_t           upload_count; // Jobs that have been uploaded, or failed
+  size_t           fail_count;
+} gui_load_t;
+
+/*
+ * Set number of asset loading worker threads, 0 for the default
+ */
+int gui_load_worker_count_set(gui_t* gui, int count)
+{
+  if (!gui || count < 0)
+  {
+    return 1;
+  }
+
+  gui->load_worker_count = count;
+
+  return 0;
+}
+
+/*
+ * Get number of asset loading worker threads
+ */
+static inline int gui_load_worker_count_get(gui_t* gui)
+{
+  int count = gui->load_worker_count ? gui->load_worker_count : GUI_LOAD_WORKER_COUNT;
+
+  if (count <= 0)
+  {
+    count = SDL_GetCPUCount();
+  }
+
+  return MAX(count, 1);
+}
+
+/*
+ * Decode the asset of job, without touching the renderer
+ */
+static inline void gui_load_job_decode(gui_load_t* load, gui_load_job_t* job)
+{
+  char* filepath = job->asset.filepath;
+
+  switch (load->kind)
+  {
+    case GUI_ASSET_TEXTURE:
+      job->surface = IMG_Load(filepath);
+
+      if (!job->surface)
+      {
+        fprintf(stderr, "IMG_Load: %s\n", IMG_GetError());
+      }
+      break;
+
+    // FreeType isn't thread safe, and SDL_mixer converts chunks
+    // to the shared output format, so only the file is read here
+    case GUI_ASSET_FONT:
+    case GUI_ASSET_CHUNK:
+      job->data = SDL_LoadFile(filepath, &job->size);
+
+      if (!job->data)
+      {
+        fprintf(stderr, "SDL_LoadFile: %s\n", SDL_GetError());
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+/*
+ * Worker thread, which decodes jobs until there are no more
+ */
+static int gui_load_worker(void* data)
+{
+  gui_load_t* load = data;
+
+  while (true)
+  {
+    size_t index = SDL_AtomicAdd(&load->next_job, 1);
+
+    if (index >= load->job_count) break;
+
+    gui_load_job_t* job = &load->jobs[index];
+
+    gui_load_job_decode(load, job);
+
+    SDL_AtomicSet(&job->is_done, 1);
+
+    SDL_SemPost(load->done_sem);
+  }
+
+  return 0;
+}
+
+/*
+ * Free what is left of a job that hasn't been uploaded
+ */
+static inline void gui_load_job_free(gui_load_job_t* job)
+{
+  if (job->surface)
+  {
+    SDL_FreeSurface(job->surface);
+
+    job->surface = NULL;
+  }
+
+  SDL_free(job->data);
+
+  job->data = NULL;
+}
+
+/*
+ * Create gui texture from surface, packed into the atlas if enabled
+ */
+static inline gui_texture_t* gui_surface_texture_create(gui_t* gui, char* name, SDL_Surface* surface)
+{
+  // Textures that don't fit in the atlas get their own texture
+  if (gui->is_texture_packed)
+  {
+    gui_texture_t* gui_texture = gui_atlas_texture_create(gui, name, surface);
+
+    if (gui_texture) return gui_texture;
+  }
+
+  SDL_Texture* texture = SDL_CreateTextureFromSurface(gui->renderer, surface);
+
+  if (!texture)
+  {
+    fprintf(stderr, "SDL_CreateTextureFromSurface: %s\n", SDL_GetError());
+
+    return NULL;
+  }
+
+  gui_texture_t* gui_texture = gui_texture_create(name, texture);
+
+  if (!gui_texture)
+  {
+    sdl_texture_destroy(&texture);
+
+    return NULL;
+  }
+
+  return gui_texture;
+}
+
+/*
+ * Move the loaded texture into the registered texture
+ */
+static inline void gui_assets_texture_move(gui_assets_t* assets, gui_texture_t* registered, gui_texture_t** loaded)
+{
+  registered->texture     = (*loaded)->texture;
+  registered->rect        = (*loaded)->rect;
+  registered->page        = (*loaded)->page;
+  registered->load_failed = false;
+
+  if (!registered->page)
+  {
+    registered->bytes = sdl_texture_bytes_get(registered->texture);
+
+    assets->texture_bytes += registered->bytes;
+  }
+
+  free(*loaded);
+
+  *loaded = NULL;
+}
+
+/*
+ * Add loaded texture to assets, or fill in the registered texture of its name
+ */
+static inline int gui_assets_texture_put(gui_assets_t* assets, gui_texture_t* texture)
+{
+  ssize_t index = gui_name_index_get(&assets->texture_index, texture->name);
+
+  gui_texture_t* registered = (index != -1) ? assets->textures[index] : NULL;
+
+  if (registered)
+  {
+    // A registered texture can already be loaded on first use,
+    // and one that failed to load lazily is filled in here
+    if (registered->texture)
+    {
+      gui_texture_destroy(&texture);
+    }
+    else gui_assets_texture_move(assets, registered, &texture);
+
+    return 0;
+  }
+
+  return gui_assets_texture_add(assets, texture);
+}
+
+/*
+ * Upload texture of job and add it to gui assets
+ */
+static inline int gui_load_texture_upload(gui_t* gui, gui_load_job_t* job)
+{
+  if (!job->surface)
+  {
+    return 1;
+  }
+
+  gui_texture_t* gui_texture = gui_surface_texture_create(gui, job->asset.name, job->surface);
+
+  SDL_FreeSurface(job->surface);
+
+  job->surface = NULL;
+
+  if (!gui_texture)
+  {
+    return 2;
+  }
+
+  if (gui_assets_texture_put(gui->assets, gui_texture) != 0)
+  {
+    gui_texture_destroy(&gui_texture);
+
+    return 3;
+  }
+
+  return 0;
+}
+
+/*
+ * Load registered texture on first use
+ *
+ * The texture is marked as failed if loading fails, so it isn't tried
+ * every frame. The path is kept, so that it can still be loaded
+ * asynchronously
+ */
+static inline int gui_texture_lazy_load(gui_t* gui, gui_texture_t* texture)
+{
+  SDL_Surface* surface = IMG_Load(texture->filepath);
+
+  if (!surface)
+  {
+    fprintf(stderr, "IMG_Load: %s\n", IMG_GetError());
+
+    texture->load_failed = true;
+
+    return 1;
+  }
+
+  gui_texture_t* loaded = gui_surface_texture_create(gui, texture->name, surface);
+
+  SDL_FreeSurface(surface);
+
+  if (!loaded)
+  {
+    texture->load_failed = true;
+
+    return 2;
+  }
+
+  gui_assets_texture_move(gui->assets, texture, &loaded);
+
+  return 0;
+}
+
+/*
+ * Open font from the file data of job and add it to gui assets
+ *
+ * The font keeps the file data, because FreeType reads from it
+ */
+static inline int gui_load_font_upload(gui_t* gui, gui_load_job_t* job)
+{
+  if (!job->data)
+  {
+    return 1;
+  }
+
+  SDL_RWops* rw = SDL_RWFromConstMem(job->data, job->size);
+
+  TTF_Font* font = rw ? TTF_OpenFontRW(rw, 1, 24) : NULL;
+
+  if (!font)
+  {
+    fprintf(stderr, "TTF_OpenFontRW: %s\n", TTF_GetError());
+
+    return 2;
+  }
+
+  gui_font_t* gui_font = gui_font_create(job->asset.name, font);
+
+  if (!gui_font)
+  {
+    ttf_font_destroy(&font);
+
+    return 3;
+  }
+
+  gui_font->data = job->data;
+
+  job->data = NULL;
+
+  if (gui_assets_font_add(gui->assets, gui_font) != 0)
+  {
+    gui_font_destroy(&gui_font);
+
+    return 4;
+  }
+
+  return 0;
+}
+
+/*
+ * Decode chunk from the file data of job and add it to gui assets
+ *
+ * The chunk is converted to the output format, so the file data is freed
+ */
+static inline int gui_load_chunk_upload(gui_t* gui, gui_load_job_t* job)
+{
+  if (!job->data)
+  {
+    return 1;
+  }
+
+  SDL_RWops* rw = SDL_RWFromConstMem(job->data, job->size);
+
+  Mix_Chunk* chunk = rw ? Mix_LoadWAV_RW(rw, 1) : NULL;
+
+  SDL_free(job->data);
+
+  job->data = NULL;
+
+  if (!chunk)
+  {
+    fprintf(stderr, "Mix_LoadWAV_RW: %s\n", Mix_GetError());
+
+    return 2;
+  }
+
+  gui_chunk_t* gui_chunk = gui_chunk_create(job->asset.name, chunk);
+
+  if (!gui_chunk)
+  {
+    mix_chunk_destroy(&chunk);
+
+    return 3;
+  }
+
+  if (gui_assets_chunk_add(gui->assets, gui_chunk) != 0)
+  {
+    gui_chunk_destroy(&gui_chunk);
+
+    return 4;
+  }
+
+  return 0;
+}
+
+/*
+ * Trigger load event, by calling handlers of type GUI_EVENT_HANDLER_LOAD
+ */
+static inline void gui_load_event_trigger(gui_t* gui, gui_event_id_t id, gui_load_t* load)
+{
+  if ((size_t) id >= gui->event_count) return;
+
+  gui_event_t* gui_event = gui->events[id];
+
+  for (size_t index = 0; index < gui_event->handler_count; index++)
+  {
+    gui_event_handler_t handler = gui_event->handlers[index];
+
+    if (handler.type == GUI_EVENT_HANDLER_LOAD && handler.handler.load)
+    {
+      handler.handler.load(gui, load->ticket, load->upload_count, load->job_count);
+    }
+  }
+}
+
+/*
+ * Upload the decoded jobs in order, on the render thread,
+ * until a job isn't decoded yet, or budget_us is spent
+ */
+static inline void gui_load_upload(gui_t* gui, gui_load_t* load, uint64_t budget_us)
+{
+  uint64_t start_us = gui_time_us_get();
+
+  while (load->upload_count < load->job_count)
+  {
+    gui_load_job_t* job = &load->jobs[load->upload_count];
+
+    if (!SDL_AtomicGet(&job->is_done)) break;
+
+    int status = 0;
+
+    switch (load->kind)
+    {
+      case GUI_ASSET_TEXTURE:
+        status = gui_load_texture_upload(gui, job);
+        break;
+
+      case GUI_ASSET_FONT:
+        status = gui_load_font_upload(gui, job);
+        break;
+
+      case GUI_ASSET_CHUNK:
+        status = gui_load_chunk_upload(gui, job);
+        break;
+
+      default:
+        break;
+    }
+
+    if (status != 0)
+    {
+      fprintf(stderr, "Failed to load asset: %s\n", job->asset.filepath);
+
+      gui_load_job_free(job);
+
+      load->fail_count++;
+    }
+
+    load->upload_count++;
+
+    if (load->ticket != GUI_TICKET_NONE)
+    {
+      gui_load_event_trigger(gui, GUI_EVENT_LOAD_PROGRESS, load);
+    }
+
+    if (gui_time_us_get() - start_us >= budget_us) break;
+  }
+}
+
+/*
+ * Destroy load, after waiting for the workers
+ */
+static inline void gui_load_destroy(gui_load_t** load)
+{
+  if (!load || !(*load)) return;
+
+  // Make the workers stop taking new jobs
+  SDL_AtomicSet(&(*load)->next_job, (*load)->job_count);
+
+  for (size_t index = 0; index < (*load)->thread_count; index++)
+  {
+    SDL_WaitThread((*load)->threads[index], NULL);
+  }
+
+  free((*load)->threads);
+
+  for (size_t index = 0; index < (*load)->job_count; index++)
+  {
+    gui_load_job_free(&(*load)->jobs[index]);
+  }
+
+  free((*load)->jobs);
+
+  if ((*load)->done_sem)
+  {
+    SDL_DestroySemaphore((*load)->done_sem);
+  }
+
+  free(*load);
+
+  *load = NULL;
+}
+
+/*
+ * Create load of assets and start its workers
+ *
+ * If no worker could be started, the assets are decoded right away
+ */
+static inline gui_load_t* gui_load_create(gui_t* gui, gui_asset_kind_t kind, gui_asset_t* assets, size_t count)
+{
+  gui_load_t* load = malloc(sizeof(gui_load_t));
+
+  if (!load)
+  {
+    return NULL;
+  }
+
+  memset(load, 0, sizeof(gui_load_t));
+
+  load->ticket = GUI_TICKET_NONE;
+
+  load->kind = kind;
+
+  load->jobs = calloc(MAX(count, 1), sizeof(gui_load_job_t));
+
+  load->done_sem = SDL_CreateSemaphore(0);
+
+  size_t thread_count = MIN((size_t) gui_load_worker_count_get(gui), count);
+
+  load->threads = malloc(sizeof(SDL_Thread*) * MAX(thread_count, 1));
+
+  if (!load->jobs || !load->done_sem || !load->threads)
+  {
+    gui_load_destroy(&load);
+
+    return NULL;
+  }
+
+  for (size_t index = 0; index < count; index++)
+  {
+    load->jobs[index].asset = assets[index];
+  }
+
+  load->job_count = count;
+
+  for (size_t index = 0; index < thread_count; index++)
+  {
+    SDL_Thread* thread = SDL_CreateThread(gui_load_worker, "gui_load_worker", load);
+
+    if (!thread)
+    {
+      fprintf(stderr, "SDL_CreateThread: %s\n", SDL_GetError());
+
+      break;
+    }
+
+    load->threads[load->thread_count++] = thread;
+  }
+
+  if (load->thread_count == 0)
+  {
+    gui_load_worker(load);
+  }
+
+  return load;
+}
+
+/*
+ * Load assets of kind with the worker pool, and wait until all are added
+ */
+static inline int gui_assets_kind_load(gui_t* gui, gui_asset_kind_t kind, gui_asset_t* assets, size_t count)
+{
+  gui_load_t* load = gui_load_create(gui, kind, assets, count);
+
+  if (!load)
+  {
+    return 1;
+  }
+
+  // Upload each asset as soon as it is decoded
+  while (load->upload_count < load->job_count)
+  {
+    SDL_SemWait(load->done_sem);
+
+    gui_load_upload(gui, load, UINT64_MAX);
+  }
+
+  int status = (load->fail_count > 0) ? 2 : 0;
+
+  gui_load_destroy(&load);
+
+  return status;
+}
+
+/*
+ * Load textures and add them to gui assets
+ *
+ * The files are decoded by worker threads,
+ * and the textures are created on the calling thread
+ */
+int gui_textures_load(gui_t* gui, gui_asset_t* assets, size_t count)
+{
+  if (!gui || !assets)
+  {
+    return 1;
+  }
+
+  return gui_assets_kind_load(gui, GUI_ASSET_TEXTURE, assets, count) ? 2 : 0;
+}
+
+/*
+ * Register textures by name and path, without loading them
+ *
+ * A registered texture is loaded when it is first rendered,
+ * or earlier by the preload group of a menu
+ */
+int gui_textures_register(gui_t* gui, gui_asset_t* assets, size_t count)
+{
+  if (!gui || !assets)
+  {
+    return 1;
+  }
+
+  for (size_t index = 0; index < count; index++)
+  {
+    gui_asset_t asset = assets[index];
+
+    if (!asset.name || !asset.filepath)
+    {
+      return 2;
+    }
+
+    if (gui_name_index_get(&gui->assets->texture_index, asset.name) != -1)
+    {
+      continue;
+    }
+
+    gui_texture_t* gui_texture = gui_texture_create(asset.name, NULL);
+
+    if (!gui_texture)
+    {
+      return 3;
+    }
+
+    gui_texture->filepath = asset.filepath;
+
+    if (gui_assets_texture_add(gui->assets, gui_texture) != 0)
+    {
+      free(gui_texture);
+
+      return 4;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Load fonts and add them to gui assets
+ */
+int gui_fonts_load(gui_t* gui, gui_asset_t* assets, size_t count)
+{
+  if (!gui || !assets)
+  {
+    return 1;
+  }
+
+  return gui_assets_kind_load(gui, GUI_ASSET_FONT, assets, count) ? 2 : 0;
+}
+
+/*
+ * Load chunks and add them to gui assets
+ */
+int gui_chunks_load(gui_t* gui, gui_asset_t* assets, size_t count)
+{
+  if (!gui || !assets)
+  {
+    return 1;
+  }
+
+  return gui_assets_kind_load(gui, GUI_ASSET_CHUNK, assets, count) ? 2 : 0;
+}
+
+/*
+ * Get loaded texture, and load it if it is registered but not loaded yet
+ */
+static inline gui_texture_t* gui_texture_use(gui_t* gui, gui_texture_t* texture)
+{
+  if (!texture->texture && (!texture->filepath || texture->load_failed || gui_texture_lazy_load(gui, texture) != 0))
+  {
+    return NULL;
+  }
+
+  texture->used_frame = gui->frame_index;
+
+  return texture;
+}
+
+/*
+ * Get loaded texture by name
+ */
+static inline gui_texture_t* gui_texture_get(gui_t* gui, char* name)
+{
+  gui_assets_t* assets = gui->assets;
+
+  ssize_t index = gui_name_index_get(&assets->texture_index, name);
+
+  return (index != -1) ? gui_texture_use(gui, assets->textures[index]) : NULL;
+}
+
+/*
+ * Get loaded texture by handle
+ */
+static inline gui_texture_t* gui_handle_texture_get(gui_t* gui, gui_handle_t handle)
+{
+  gui_assets_t* assets = gui->assets;
+
+  if (handle < 0 || (size_t) handle >= assets->texture_count)
+  {
+    return NULL;
+  }
+
+  return gui_texture_use(gui, assets->textures[handle]);
+}
+
+/*
+ * Resolve name of loaded texture to handle
+ */
+gui_handle_t gui_texture_handle_get(gui_t* gui, const char* name)
+{
+  if (!gui || !gui->assets || !name)
+  {
+    return GUI_HANDLE_NONE;
+  }
+
+  ssize_t index = gui_name_index_get(&gui->assets->texture_index, name);
+
+  return (index != -1) ? (gui_handle_t) index : GUI_HANDLE_NONE;
+}
+
+/*
+ * Get loaded font by name
+ */
+static inline gui_font_t* gui_font_get(gui_t* gui, char* name)
+{
+  gui_assets_t* assets = gui->assets;
+
+  ssize_t index = gui_name_index_get(&assets->font_index, name);
+
+  return (index != -1) ? assets->fonts[index] : NULL;
+}
+
+/*
+ * Get loaded font by handle
+ */
+static inline gui_font_t* gui_handle_font_get(gui_t* gui, gui_handle_t handle)
+{
+  gui_assets_t* assets = gui->assets;
+
+  if (handle < 0 || (size_t) handle >= assets->font_count)
+  {
+    return NULL;
+  }
+
+  return assets->fonts[handle];
+}
+
+/*
+ * Resolve name of loaded font to handle
+ */
+gui_handle_t gui_font_handle_get(gui_t* gui, const char* name)
+{
+  if (!gui || !gui->assets || !name)
+  {
+    return GUI_HANDLE_NONE;
+  }
+
+  ssize_t index = gui_name_index_get(&gui->assets->font_index, name);
+
+  return (index != -1) ? (gui_handle_t) index : GUI_HANDLE_NONE;
+}
+
+/*
+ * Get loaded chunk by name
+ */
+static inline gui_chunk_t* gui_chunk_get(gui_t* gui, char* name)
+{
+  gui_assets_t* assets = gui->assets;
+
+  ssize_t index = gui_name_index_get(&assets->chunk_index, name);
+
+  return (index != -1) ? assets->chunks[index] : NULL;
+}
+
+/*
+ * Get loaded chunk by handle
+ */
+static inline gui_chunk_t* gui_handle_chunk_get(gui_t* gui, gui_handle_t handle)
+{
+  gui_assets_t* assets = gui->assets;
+
+  if (handle < 0 || (size_t) handle >= assets->chunk_count)
+  {
+    return NULL;
+  }
+
+  return assets->chunks[handle];
+}
+
+/*
+ * Resolve name of loaded chunk to handle
+ */
+gui_handle_t gui_chunk_handle_get(gui_t* gui, const char* name)
+{
+  if (!gui || !gui->assets || !name)
+  {
+    return GUI_HANDLE_NONE;
+  }
+
+  ssize_t index = gui_name_index_get(&gui->assets->chunk_index, name);
+
+  return (index != -1) ? (gui_handle_t) index : GUI_HANDLE_NONE;
+}
+
+/*
+ * Chunk
+ */
+
+/*
+ * Play loaded chunk
+ */
+int gui_chunk_play(gui_t* gui, char* name)
+{
+  if (!gui || !name)
+  {
+    return 1;
+  }
+
+  gui_chunk_t* chunk = gui_chunk_get(gui, name);
+
+  if (!chunk)
+  {
+    return 2;
+  }
+
+  if (mix_chunk_play(chunk->chunk) != 0)
+  {
+    return 3;
+  }
+
+  return 0;
+}
+
+/*
+ * Play loaded chunk by handle
+ */
+int gui_chunk_handle_play(gui_t* gui, gui_handle_t handle)
+{
+  if (!gui)
+  {
+    return 1;
+  }
+
+  gui_chunk_t* chunk = gui_handle_chunk_get(gui, handle);
+
+  if (!chunk)
+  {
+    return 2;
+  }
+
+  if (mix_chunk_play(chunk->chunk) != 0)
+  {
+    return 3;
+  }
+
+  return 0;
+}
+
+/*
+ * Font
+ */
+
+/*
+ * Get texture of text
+ *
+ * Maybe: replace with gui_text_t text 
+ */
+static inline SDL_Texture* sdl_text_texture_create(SDL_Renderer* renderer, const char* text, TTF_Font* font, SDL_Color color)
+{
+  SDL_Surface* surface = TTF_RenderText_Solid(font, text, color);
+
+  if (!surface)
+  {
+    return NULL;
+  }
+
+  SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+
+  SDL_FreeSurface(surface);
+
+  if (!texture)
+  {
+    fprintf(stderr, "SDL_CreateTextureFromSurface: %s\n", SDL_GetError());
+
+    return NULL;
+  }
+
+  return texture;
+}
+
+/*
+ * Get width and height of texture
+ */
+static inline int gui_texture_w_and_h_get(int* w, int* h, SDL_Texture* texture)
+{
+  if (SDL_QueryTexture(texture, NULL, NULL, w, h) != 0)
+  {
+    fprintf(stderr, "SDL_QueryTexture: %s\n", SDL_GetError());
+
+    return 1;
+  }
+
+  return 0;
+}
+
+/*
+ * Glyph atlas
+ */
+
+/*
+ * Create glyph atlas of font
+ */
+static inline gui_glyph_atlas_t* gui_glyph_atlas_create(SDL_Renderer* renderer, TTF_Font* font, int width, int height)
+{
+  gui_glyph_atlas_t* atlas = malloc(sizeof(gui_glyph_atlas_t));
+
+  if (!atlas)
+  {
+    return NULL;
+  }
+
+  memset(atlas, 0, sizeof(gui_glyph_atlas_t));
+
+  atlas->texture = sdl_atlas_texture_create(renderer, width, height);
+
+  if (!atlas->texture)
+  {
+    free(atlas);
+
+    return NULL;
+  }
+
+  atlas->font        = font;
+  atlas->width       = width;
+  atlas->height      = height;
+  atlas->line_height = TTF_FontHeight(font);
+
+  return atlas;
+}
+
+/*
+ * Replace the atlas texture with a larger one
+ *
+ * All glyphs are dropped and rasterized again on next use
+ */
+static inline int gui_glyph_atlas_grow(gui_glyph_atlas_t* atlas, SDL_Renderer* renderer)
+{
+  SDL_Texture* texture = sdl_atlas_texture_create(renderer, atlas->width, atlas->height * 2);
+
+  if (!texture)
+  {
+    return 1;
+  }
+
+  sdl_texture_destroy(&atlas->texture);
+
+  atlas->texture = texture;
+  atlas->height *= 2;
+
+  memset(atlas->glyphs, 0, sizeof(atlas->glyphs));
+
+  atlas->pen_x      = 0;
+  atlas->pen_y      = 0;
+  atlas->row_height = 0;
+
+  return 0;
+}
+
+/*
+ * Rasterize glyph and upload it to the atlas texture
+ *
+ * The glyph is rendered as a one character string,
+ * to get the same size and placement as TTF_RenderText
+ */
+static inline int gui_glyph_atlas_glyph_load(gui_glyph_atlas_t* atlas, TTF_Font* font, unsigned char symbol)
+{
+  gui_glyph_t* glyph = &atlas->glyphs[symbol];
+
+  int advance = 0;
+
+  if (TTF_GlyphMetrics(font, symbol, NULL, NULL, NULL, NULL, &advance) != 0)
+  {
+    // The font does not have the glyph, it takes no space
+    glyph->is_loaded = true;
+
+    return 0;
+  }
+
+  glyph->advance = advance;
+
+  char string[2] = { (char) symbol, '\0' };
+
+  SDL_Surface* surface = TTF_RenderText_Blended(font, string, (SDL_Color) { 255, 255, 255, 255 });
+
+  if (!surface)
+  {
+    // Glyphs without pixels, like space, only advance
+    glyph->is_loaded = true;
+
+    return 0;
+  }
+
+  SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+
+  SDL_FreeSurface(surface);
+
+  if (!converted)
+  {
+    fprintf(stderr, "SDL_ConvertSurfaceFormat: %s\n", SDL_GetError());
+
+    return 1;
+  }
+
+  // Keep one pixel of padding between glyphs, to avoid bleeding
+  if (atlas->pen_x + converted->w + 1 > atlas->width)
+  {
+    atlas->pen_x       = 0;
+    atlas->pen_y      += atlas->row_height + 1;
+    atlas->row_height  = 0;
+  }
+
+  if (atlas->pen_y + converted->h + 1 > atlas->height || converted->w + 1 > atlas->width)
+  {
+    SDL_FreeSurface(converted);
+
+    return 2;
+  }
+
+  SDL_Rect rect = { atlas->pen_x, atlas->pen_y, converted->w, converted->h };
+
+  int status = SDL_UpdateTexture(atlas->texture, &rect, converted->pixels, converted->pitch);
+
+  SDL_FreeSurface(converted);
+
+  if (status != 0)
+  {
+    fprintf(stderr, "SDL_UpdateTexture: %s\n", SDL_GetError());
+
+    return 3;
+  }
+
+  atlas->pen_x      += rect.w + 1;
+  atlas->row_height  = MAX(atlas->row_height, rect.h);
+
+  glyph->rect      = rect;
+  glyph->is_loaded = true;
+
+  atlas->raster_count++;
+
+  return 0;
+}
+
+/*
+ * Make sure that every glyph of text is in the atlas
+ */
+static inline int gui_glyph_atlas_text_load(gui_glyph_atlas_t* atlas, SDL_Renderer* renderer, TTF_Font* font, const char* text)
+{
+  const unsigned char* symbols = (const unsigned char*) text;
+
+  for (size_t index = 0; symbols[index]; index++)
+  {
+    if (atlas->glyphs[symbols[index]].is_loaded) continue;
+
+    int status = gui_glyph_atlas_glyph_load(atlas, font, symbols[index]);
+
+    if (status == 2)
+    {
+      // The atlas is full, grow it and start over with the whole text
+      if (atlas->height >= 8 * atlas->width || gui_glyph_atlas_grow(atlas, renderer) != 0)
+      {
+        return 1;
+      }
+
+      index = (size_t) -1;
+    }
+    else if (status != 0)
+    {
+      return 2;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Get the glyph atlas of font, create it on first use
+ */
+static inline gui_glyph_atlas_t* gui_font_atlas_get(gui_t* gui, gui_font_t* font)
+{
+  if (!font->atlas)
+  {
+    font->atlas = gui_glyph_atlas_create(gui->renderer, font->font, GUI_GLYPH_ATLAS_SIZE, GUI_GLYPH_ATLAS_SIZE);
+  }
+
+  return font->atlas;
+}
+
+/*
+ * Get kerning between two glyphs of atlas, or 0 for the first glyph
+ */
+static inline int gui_glyph_atlas_kerning_get(gui_glyph_atlas_t* atlas, const unsigned char* symbol, const unsigned char* text)
+{
+  if (symbol == text) return 0;
+
+  return TTF_GetFontKerningSizeGlyphs(atlas->font, *(symbol - 1), *symbol);
+}
+
+/*
+ * Get width and height of text, rendered with glyph atlas
+ */
+static inline int gui_glyph_atlas_text_size(gui_glyph_atlas_t* atlas, const char* text, int* w, int* h)
+{
+  int width = 0;
+  int pen_x = 0;
+
+  for (const unsigned char* symbol = (const unsigned char*) text; *symbol; symbol++)
+  {
+    gui_glyph_t* glyph = &atlas->glyphs[*symbol];
+
+    pen_x += gui_glyph_atlas_kerning_get(atlas, symbol, (const unsigned char*) text);
+
+    width  = MAX(width, pen_x + glyph->rect.w);
+    pen_x += glyph->advance;
+  }
+
+  *w = MAX(width, pen_x);
+  *h = atlas->line_height;
+
+  return (*w > 0 && *h > 0) ? 0 : 1;
+}
+
+/*
+ * Make sure that the scratch buffers can hold count quads
+ */
+static inline int gui_glyph_atlas_reserve(gui_glyph_atlas_t* atlas, size_t count)
+{
+  if (count <= atlas->capacity) return 0;
+
+  size_t capacity = MAX(count, atlas->capacity * 2);
+
+  SDL_Vertex* vertices = realloc(atlas->vertices, sizeof(SDL_Vertex) * capacity * 4);
+
+  if (!vertices)
+  {
+    return 1;
+  }
+
+  atlas->vertices = vertices;
+
+  int* indices = realloc(atlas->indices, sizeof(int) * capacity * 6);
+
+  if (!indices)
+  {
+    return 2;
+  }
+
+  atlas->indices  = indices;
+  atlas->capacity = capacity;
+
+  return 0;
+}
+
+/*
+ * Render text to target texture, as one batch of glyph quads
+ *
+ * The glyphs of text must already be loaded,
+ * the text is stretched to fill rect
+ */
+static inline int gui_glyph_atlas_text_render(gui_glyph_atlas_t* atlas, gui_t* gui, SDL_Texture* target, const char* text, gui_color_t color, SDL_Rect rect)
+{
+  int textw;
+  int texth;
+
+  if (gui_glyph_atlas_text_size(atlas, text, &textw, &texth) != 0)
+  {
+    return 1;
+  }
+
+  if (gui_glyph_atlas_reserve(atlas, strlen(text)) != 0)
+  {
+    return 2;
+  }
+
+  float scale_x = (float) rect.w / (float) textw;
+  float scale_y = (float) rect.h / (float) texth;
+
+  // Like TTF_RenderText_Solid, treat fully transparent color as opaque
+  SDL_Color sdl_color = sdl_color_create(color);
+
+  if (sdl_color.a == 0) sdl_color.a = 255;
+
+  SDL_Vertex* vertices = atlas->vertices;
+  int*        indices  = atlas->indices;
+
+  int quad_count = 0;
+  int pen_x = 0;
+
+  for (const unsigned char* symbol = (const unsigned char*) text; *symbol; symbol++)
+  {
+    gui_glyph_t* glyph = &atlas->glyphs[*symbol];
+
+    pen_x += gui_glyph_atlas_kerning_get(atlas, symbol, (const unsigned char*) text);
+
+    if (glyph->rect.w > 0 && glyph->rect.h > 0)
+    {
+      float x1 = rect.x + pen_x * scale_x;
+      float y1 = rect.y;
+      float x2 = x1 + glyph->rect.w * scale_x;
+      float y2 = y1 + glyph->rect.h * scale_y;
+
+      float u1 = (float) glyph->rect.x / atlas->width;
+      float v1 = (float) glyph->rect.y / atlas->height;
+      float u2 = (float) (glyph->rect.x + glyph->rect.w) / atlas->width;
+      float v2 = (float) (glyph->rect.y + glyph->rect.h) / atlas->height;
+
+      SDL_Vertex* vertex = &vertices[quad_count * 4];
+
+      vertex[0] = (SDL_Vertex) { { x1, y1 }, sdl_color, { u1, v1 } };
+      vertex[1] = (SDL_Vertex) { { x2, y1 }, sdl_color, { u2, v1 } };
+      vertex[2] = (SDL_Vertex) { { x2, y2 }, sdl_color, { u2, v2 } };
+      vertex[3] = (SDL_Vertex) { { x1, y2 }, sdl_color, { u1, v2 } };
+
+      int* index = &indices[quad_count * 6];
+      int  first = quad_count * 4;
+
+      index[0] = first + 0;
+      index[1] = first + 1;
+      index[2] = first + 2;
+      index[3] = first + 0;
+      index[4] = first + 2;
+      index[5] = first + 3;
+
+      quad_count++;
+    }
+
+    pen_x += glyph->advance;
+  }
+
+  if (quad_count == 0) return 0;
+
+  if (gui_target_geometry_render(gui, target, atlas->texture, vertices, quad_count * 4, indices, quad_count * 6) != 0)
+  {
+    return 3;
+  }
+
+  return 0;
+}
+
+/*
+ * Set the engine used to render text
+ */
+int gui_text_engine_set(gui_t* gui, gui_text_engine_t engine)
+{
+  if (!gui)
+  {
+    return 1;
+  }
+
+  gui->text_engine = engine;
+
+  return 0;
+}
+
+/*
+ * Text cache
+ */
+
+/*
+ * Hash the key of a text entry
+ */
+static inline uint32_t gui_text_hash(gui_font_t* font, const char* text, gui_color_t color)
+{
+  uint32_t hash = 2166136261u;
+
+  hash = gui_bytes_hash(hash, &font, sizeof(font));
+  hash = gui_bytes_hash(hash, &color, sizeof(color));
+
+  return gui_string_hash(hash, text);
+}
+
+/*
+ * Check if the text entry has the key (font, text, color)
+ */
+static inline bool gui_text_entry_is(gui_text_entry_t* entry, gui_font_t* font, const char* text, gui_color_t color)
+{
+  return (entry->font == font &&
+          entry->color.r == color.r && entry->color.g == color.g &&
+          entry->color.b == color.b && entry->color.a == color.a &&
+          strcmp(entry->text, text) == 0);
+}
+
+/*
+ * Destroy text entry
+ */
+static inline void gui_text_entry_destroy(gui_text_entry_t** entry)
+{
+  if (!entry || !(*entry)) return;
+
+  sdl_texture_destroy(&(*entry)->texture);
+
+  free((*entry)->text);
+
+  free(*entry);
+
+  *entry = NULL;
+}
+
+/*
+ * Unlink text entry from the LRU list
+ */
+static inline void gui_text_cache_lru_remove(gui_text_cache_t* cache, gui_text_entry_t* entry)
+{
+  if (entry->newer) entry->newer->older = entry->older;
+  else              cache->newest       = entry->older;
+
+  if (entry->older) entry->older->newer = entry->newer;
+  else              cache->oldest       = entry->newer;
+
+  entry->newer = NULL;
+  entry->older = NULL;
+}
+
+/*
+ * Link text entry as the newest in the LRU list
+ */
+static inline void gui_text_cache_lru_push(gui_text_cache_t* cache, gui_text_entry_t* entry)
+{
+  entry->older = cache->newest;
+  entry->newer = NULL;
+
+  if (cache->newest) cache->newest->newer = entry;
+  else               cache->oldest        = entry;
+
+  cache->newest = entry;
+}
+
+/*
+ * Remove text entry from cache and destroy it
+ */
+static inline void gui_text_cache_entry_remove(gui_text_cache_t* cache, gui_text_entry_t* entry)
+{
+  gui_text_entry_t** link = &cache->buckets[entry->hash % cache->bucket_count];
+
+  while (*link && *link != entry)
+  {
+    link = &(*link)->next;
+  }
+
+  if (*link)
+  {
+    *link = entry->next;
+  }
+
+  gui_text_cache_lru_remove(cache, entry);
+
+  cache->bytes -= entry->bytes;
+  cache->entry_count--;
+
+  gui_text_entry_destroy(&entry);
+}
+
+/*
+ * Evict the least recently used entries until the cache is within budget
+ *
+ * The newest entry is always kept, because it is about to be rendered
+ */
+static inline void gui_text_cache_trim(gui_text_cache_t* cache)
+{
+  while (cache->bytes > cache->budget && cache->oldest && cache->oldest != cache->newest)
+  {
+    gui_text_cache_entry_remove(cache, cache->oldest);
+  }
+}
+
+/*
+ * Grow the bucket array and rehash the entries
+ */
+static inline int gui_text_cache_grow(gui_text_cache_t* cache)
+{
+  size_t bucket_count = cache->bucket_count ? cache->bucket_count * 2 : 64;
+
+  gui_text_entry_t** buckets = calloc(bucket_count, sizeof(gui_text_entry_t*));
+
+  if (!buckets)
+  {
+    return 1;
+  }
+
+  for (size_t index = 0; index < cache->bucket_count; index++)
+  {
+    gui_text_entry_t* entry = cache->buckets[index];
+
+    while (entry)
+    {
+      gui_text_entry_t* next = entry->next;
+
+      entry->next = buckets[entry->hash % bucket_count];
+
+      buckets[entry->hash % bucket_count] = entry;
+
+      entry = next;
+    }
+  }
+
+  free(cache->buckets);
+
+  cache->buckets      = buckets;
+  cache->bucket_count = bucket_count;
+
+  return 0;
+}
+
+/*
+ * Destroy all entries of text cache
+ */
+static inline void gui_text_cache_free(gui_text_cache_t* cache)
+{
+  gui_text_entry_t* entry = cache->newest;
+
+  while (entry)
+  {
+    gui_text_entry_t* older = entry->older;
+
+    gui_text_entry_destroy(&entry);
+
+    entry = older;
+  }
+
+  free(cache->buckets);
+
+  cache->buckets      = NULL;
+  cache->bucket_count = 0;
+  cache->entry_count  = 0;
+  cache->newest       = NULL;
+  cache->oldest       = NULL;
+  cache->bytes        = 0;
+}
+
+/*
+ * Get texture of text from the text cache
+ *
+ * The text is only rendered and uploaded if it is not already cached.
+ * The returned texture is owned by the cache
+ */
+static inline SDL_Texture* gui_text_texture_get(gui_t* gui, gui_font_t* font, gui_text_t text, int* w, int* h)
+{
+  gui_text_cache_t* cache = &gui->text_cache;
+
+  uint32_t hash = gui_text_hash(font, text.text, text.color);
+
+  if (cache->bucket_count > 0)
+  {
+    gui_text_entry_t* entry = cache->buckets[hash % cache->bucket_count];
+
+    for (; entry; entry = entry->next)
+    {
+      if (entry->hash == hash && gui_text_entry_is(entry, font, text.text, text.color))
+      {
+        gui_text_cache_lru_remove(cache, entry);
+
+        gui_text_cache_lru_push(cache, entry);
+
+        entry->used_frame = gui->frame_index;
+
+        *w = entry->width;
+        *h = entry->height;
+
+        return entry->texture;
+      }
+    }
+  }
+
+  if (cache->entry_count >= cache->bucket_count && gui_text_cache_grow(cache) != 0)
+  {
+    return NULL;
+  }
+
+  gui_text_entry_t* entry = malloc(sizeof(gui_text_entry_t));
+
+  if (!entry)
+  {
+    return NULL;
+  }
+
+  memset(entry, 0, sizeof(gui_text_entry_t));
+
+  entry->text = strdup(text.text);
+
+  if (!entry->text)
+  {
+    free(entry);
+
+    return NULL;
+  }
+
+  SDL_Color sdl_color = sdl_color_create(text.color);
+
+  entry->texture = sdl_text_texture_create(gui->renderer, text.text, font->font, sdl_color);
+
+  if (!entry->texture || gui_texture_w_and_h_get(&entry->width, &entry->height, entry->texture) != 0)
+  {
+    gui_text_entry_destroy(&entry);
+
+    return NULL;
+  }
+
+  entry->font  = font;
+  entry->color = text.color;
+  entry->hash  = hash;
+  entry->used_frame = gui->frame_index;
+  entry->bytes = (size_t) entry->width * entry->height * 4 + strlen(entry->text);
+
+  entry->next = cache->buckets[hash % cache->bucket_count];
+
+  cache->buckets[hash % cache->bucket_count] = entry;
+
+  gui_text_cache_lru_push(cache, entry);
+
+  cache->bytes += entry->bytes;
+  cache->entry_count++;
+
+  gui_text_cache_trim(cache);
+
+  *w = entry->width;
+  *h = entry->height;
+
+  return entry->texture;
+}
+
+/*
+ * Set the memory budget (in bytes) of the text cache
+ */
+int gui_text_cache_budget_set(gui_t* gui, size_t bytes)
+{
+  if (!gui)
+  {
+    return 1;
+  }
+
+  gui->text_cache.budget = bytes;
+
+  gui_text_cache_trim(&gui->text_cache);
+
+  return 0;
+}
+
+/*
+ * Window
+ */
+
+/*
+ * Get the absolute pixel size from gui_size
+ * in case of relative size, parent_size is used in relation
+ */
+static inline int gui_size_abs_get(int parent_size, gui_size_t gui_size)
+{
+  switch (gui_size.type)
+  {
+    case GUI_SIZE_REL:
+      return parent_size * gui_size.value.rel;
+
+    case GUI_SIZE_ABS:
+      return gui_size.value.abs;
+
+    case GUI_SIZE_MAX:
+      return parent_size;
+
+    default: case GUI_SIZE_NONE:
+      return 0;
+  }
+}
+
+/*
+ *
+ */
+static inline int sdl_rect_x_get(gui_pos_t pos, int left_width, int right_width, int parent_width, int w)
+{
+  switch (pos)
+  {
+    case GUI_POS_LEFT:
+      return left_width;
+
+    case GUI_POS_RIGHT:
+      return parent_width - w - right_width;
+
+    default: case GUI_POS_CENTER:
+      return (float) (parent_width - w) / 2.f;
+  }
+}
+
+/*
+ *
+ */
+static inline int sdl_rect_y_get(gui_pos_t pos, int top_height, int bottom_height, int parent_height, int h)
+{
+  switch (pos)
+  {
+    case GUI_POS_TOP:
+      return top_height;
+
+    case GUI_POS_BOTTOM:
+      return parent_height - h - bottom_height;
+
+    default: case GUI_POS_CENTER:
+      return (float) (parent_height - h) / 2.f;
+  }
+}
+
+/*
+ *
+ */
+static inline int sdl_rect_w_get(int left_width, int right_width, int parent_width, gui_size_t width)
+{
+  int abs_width = gui_size_abs_get(parent_width, width);
+
+  return MIN(parent_width - left_width - right_width, abs_width);
+}
+
+/*
+ *
+ */
+static inline int sdl_rect_h_get(int top_height, int bottom_height, int parent_height, gui_size_t height)
+{
+  int abs_height = gui_size_abs_get(parent_height, height);
+
+  return  MIN(parent_height - top_height - bottom_height, abs_height);
+}
+
+/*
+ * Create SDL Rect from gui_rect,
+ * with the help of parent width and height and aspect ratio
+ */
+static inline SDL_Rect sdl_rect_create(gui_rect_t gui_rect, int parent_width, int parent_height)
+{
+  int left_width    = gui_size_abs_get(parent_width,  gui_rect.left);
+  int right_width   = gui_size_abs_get(parent_width,  gui_rect.right);
+  int top_height    = gui_size_abs_get(parent_height, gui_rect.top);
+  int bottom_height = gui_size_abs_get(parent_height, gui_rect.bottom);
+
+  int w = sdl_rect_w_get(left_width, right_width, parent_width, gui_rect.width);
+
+  int h = sdl_rect_h_get(top_height, bottom_height, parent_height, gui_rect.height);
+
+  if (gui_rect.aspect_ratio)
+  {
+    if (gui_rect.width.type == GUI_SIZE_NONE)
+    {
+      w = (float) h * gui_rect.aspect_ratio;
+    }
+    else if (gui_rect.height.type == GUI_SIZE_NONE)
+    {
+      h = (float) w / gui_rect.aspect_ratio;
+    }
+  }
+
+  int x = sdl_rect_x_get(gui_rect.xpos, left_width, right_width, parent_width, w);
+
+  int y = sdl_rect_y_get(gui_rect.ypos, top_height, bottom_height, parent_height, h);
+
+  return (SDL_Rect) {x, y, w, h};
+}
+
+/*
+ * Mark area of menu texture as changed
+ */
+static inline void gui_menu_damage(gui_menu_t* menu, SDL_Rect rect)
+{
+  SDL_UnionRect(&menu->damage, &rect, &menu->damage);
+
+  menu->is_dirty = true;
+}
+
+/*
+ * Get menu texture, and create it again if it was evicted
+ *
+ * The windows are composited again onto the new texture
+ */
+static inline SDL_Texture* gui_menu_target_get(gui_menu_t* menu)
+{
+  if (menu->texture) return menu->texture;
+
+  gui_t* gui = menu->gui;
+
+  menu->texture = gui_target_texture_create(gui, gui->width, gui->height);
+
+  if (!menu->texture || gui_target_clear(gui, menu->texture) != 0)
+  {
+    return NULL;
+  }
+
+  gui_menu_damage(menu, (SDL_Rect) { 0, 0, gui->width, gui->height });
+
+  return menu->texture;
+}
+
+/*
+ * Mark area of window texture as changed
+ *
+ * The damage is propagated up to the parent window or menu,
+ * so that only changed windows have to be composited again
+ */
+static inline void gui_window_damage(gui_window_t* window, SDL_Rect rect)
+{
+  SDL_Rect bounds = { 0, 0, window->sdl_rect.w, window->sdl_rect.h };
+
+  if (!SDL_IntersectRect(&rect, &bounds, &rect))
+  {
+    return;
+  }
+
+  SDL_UnionRect(&window->damage, &rect, &window->damage);
+
+  window->is_dirty = true;
+
+  SDL_Rect parent_rect = { rect.x + window->sdl_rect.x, rect.y + window->sdl_rect.y, rect.w, rect.h };
+
+  if (window->is_child)
+  {
+    if (window->parent.window)
+    {
+      gui_window_damage(window->parent.window, parent_rect);
+    }
+  }
+  else
+  {
+    if (window->parent.menu)
+    {
+      gui_menu_damage(window->parent.menu, parent_rect);
+    }
+  }
+}
+
+/*
+ * Mark the whole window texture as changed
+ */
+static inline void gui_window_damage_all(gui_window_t* window)
+{
+  gui_window_damage(window, (SDL_Rect) { 0, 0, window->sdl_rect.w, window->sdl_rect.h });
+}
+
+/*
+ * Mark area of the parent texture, that the window covers, as changed
+ */
+static inline void gui_window_parent_damage(gui_window_t* window, SDL_Rect rect)
+{
+  if (window->is_child)
+  {
+    if (window->parent.window)
+    {
+      gui_window_damage(window->parent.window, rect);
+    }
+  }
+  else
+  {
+    if (window->parent.menu)
+    {
+      gui_menu_damage(window->parent.menu, rect);
+    }
+  }
+}
+
+/*
+ * Hit test grid
+ */
+
+/*
+ * Check if x and y is inside SDL Rect
+ */
+static inline bool x_and_y_is_inside_rect(int x, int y, SDL_Rect rect)
+{
+  return (x >= rect.x && x <= (rect.x + rect.w) &&
+          y >= rect.y && y <= (rect.y + rect.h));
+}
+
+/*
+ * Free cells of hit test grid
+ */
+static inline void gui_grid_free(gui_grid_t* grid)
+{
+  if (!grid->cells) return;
+
+  for (int index = 0; index < grid->cols * grid->rows; index++)
+  {
+    free(grid->cells[index].indices);
+  }
+
+  free(grid->cells);
+
+  *grid = (gui_grid_t) { 0 };
+}
+
+/*
+ * Mark hit test grid as outdated, it is rebuilt on next hit test
+ */
+static inline void gui_grid_invalidate(gui_grid_t* grid)
+{
+  grid->is_valid = false;
+}
+
+/*
+ * Get column and row of x and y, clamped to the grid
+ */
+static inline void gui_grid_cell_get(gui_grid_t* grid, int x, int y, int* col, int* row)
+{
+  *col = (x < 0) ? 0 : MIN(x / grid->cell_w, grid->cols - 1);
+  *row = (y < 0) ? 0 : MIN(y / grid->cell_h, grid->rows - 1);
+}
+
+/*
+ * Add window index to every cell that the window rect overlaps
+ */
+static inline int gui_grid_window_add(gui_grid_t* grid, gui_window_t* window, size_t window_index)
+{
+  SDL_Rect rect = window->sdl_rect;
+
+  int min_col, min_row, max_col, max_row;
+
+  gui_grid_cell_get(grid, rect.x, rect.y, &min_col, &min_row);
+
+  gui_grid_cell_get(grid, rect.x + rect.w, rect.y + rect.h, &max_col, &max_row);
+
+  for (int row = min_row; row <= max_row; row++)
+  {
+    for (int col = min_col; col <= max_col; col++)
+    {
+      gui_grid_cell_t* cell = &grid->cells[row * grid->cols + col];
+
+      if (cell->count >= cell->capacity)
+      {
+        size_t capacity = cell->capacity ? cell->capacity * 2 : 4;
+
+        size_t* temp_indices = realloc(cell->indices, sizeof(size_t) * capacity);
+
+        if (!temp_indices)
+        {
+          return 1;
+        }
+
+        cell->indices  = temp_indices;
+        cell->capacity = capacity;
+      }
+
+      cell->indices[cell->count++] = window_index;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Build hit test grid over windows in an area of width and height
+ *
+ * The grid gets about one cell per window
+ */
+static inline int gui_grid_build(gui_grid_t* grid, gui_window_t** windows, size_t count, int width, int height)
+{
+  gui_grid_free(grid);
+
+  int side = 1;
+
+  while (side < GUI_GRID_MAX_SIDE && (size_t) (side * side) < count)
+  {
+    side++;
+  }
+
+  grid->cols = side;
+  grid->rows = side;
+
+  grid->cell_w = MAX(1, (width  + side - 1) / side);
+  grid->cell_h = MAX(1, (height + side - 1) / side);
+
+  grid->cells = calloc(side * side, sizeof(gui_grid_cell_t));
+
+  if (!grid->cells)
+  {
+    return 1;
+  }
+
+  for (size_t index = 0; index < count; index++)
+  {
+    if (gui_grid_window_add(grid, windows[index], index) != 0)
+    {
+      gui_grid_free(grid);
+
+      return 2;
+    }
+  }
+
+  grid->count    = count;
+  grid->is_valid = true;
+
+  return 0;
+}
+
+/*
+ * Add the last created window to hit test grid
+ *
+ * The grid is rebuilt instead, if it has grown too crowded
+ */
+static inline void gui_grid_window_append(gui_grid_t* grid, gui_window_t** windows, size_t count)
+{
+  if (!grid->is_valid) return;
+
+  if (count > grid->count * 2 || gui_grid_window_add(grid, windows[count - 1], count - 1) != 0)
+  {
+    gui_grid_invalidate(grid);
+  }
+}
+
+/*
+ * Get the top window which x and y is pointing at, by scanning all windows
+ */
+static inline gui_window_t* gui_windows_x_and_y_scan(gui_window_t** windows, size_t count, int x, int y)
+{
+  for (size_t index = count; index-- > 0;)
+  {
+    gui_window_t* window = windows[index];
+
+    if (x_and_y_is_inside_rect(x, y, window->sdl_rect))
+    {
+      return window;
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * Get the top window which x and y is pointing at, by using hit test grid
+ *
+ * Few windows are scanned instead, and so are all if the grid can't be built
+ */
+static inline gui_window_t* gui_grid_x_and_y_window_get(gui_grid_t* grid, gui_window_t** windows, size_t count, int width, int height, int x, int y)
+{
+  if (count < GUI_GRID_MIN_COUNT)
+  {
+    return gui_windows_x_and_y_scan(windows, count, x, y);
+  }
+
+  if (!grid->is_valid && gui_grid_build(grid, windows, count, width, height) != 0)
+  {
+    return gui_windows_x_and_y_scan(windows, count, x, y);
+  }
+
+  int col, row;
+
+  gui_grid_cell_get(grid, x, y, &col, &row);
+
+  gui_grid_cell_t* cell = &grid->cells[row * grid->cols + col];
+
+  for (size_t index = cell->count; index-- > 0;)
+  {
+    gui_window_t* window = windows[cell->indices[index]];
+
+    if (x_and_y_is_inside_rect(x, y, window->sdl_rect))
+    {
+      return window;
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * Forget window that is about to be destroyed, if it is hovered
+ */
+static inline void gui_hover_forget(gui_t* gui, gui_window_t* window)
+{
+  if (gui->curr_window == window)
+  {
+    gui->curr_window = NULL;
+  }
+
+  if (gui->last_window == window)
+  {
+    gui->last_window = NULL;
+  }
+
+  gui->is_hover_cached = false;
+}
+
+/*
+ * Draw list
+ */
+
+/*
+ * Free the drawings of draw list
+ */
+static inline void gui_draw_list_free(gui_draw_list_t* list)
+{
+  for (size_t index = 0; index < list->count; index++)
+  {
+    free(list->draws[index].name);
+    free(list->draws[index].text);
+  }
+
+  free(list->draws);
+
+  list->draws    = NULL;
+  list->count    = 0;
+  list->capacity = 0;
+}
+
+/*
+ * Append drawing to draw list, with copies of its strings
+ */
+static inline int gui_draw_list_append(gui_draw_list_t* list, gui_draw_t draw)
+{
+  draw.name = draw.name ? strdup(draw.name) : NULL;
+  draw.text = draw.text ? strdup(draw.text) : NULL;
+
+  if ((draw.kind != GUI_DRAW_BORDER && !draw.name) || (draw.kind == GUI_DRAW_TEXT && !draw.text))
+  {
+    free(draw.name);
+    free(draw.text);
+
+    return 1;
+  }
+
+  if (list->count == list->capacity)
+  {
+    size_t capacity = MAX(16, list->capacity * 2);
+
+    gui_draw_t* temp_draws = realloc(list->draws, sizeof(gui_draw_t) * capacity);
+
+    if (!temp_draws)
+    {
+      free(draw.name);
+      free(draw.text);
+
+      return 2;
+    }
+
+    list->draws    = temp_draws;
+    list->capacity = capacity;
+  }
+
+  list->draws[list->count++] = draw;
+
+  return 0;
+}
+
+/*
+ * Check if window is rendered to a texture of its own
+ *
+ * In direct mode, only cached windows and their children have textures
+ */
+static inline bool gui_window_is_textured(gui_window_t* window)
+{
+  if (window->gui->composite == GUI_COMPOSITE_TEXTURE)
+  {
+    return true;
+  }
+
+  for (; window; window = window->is_child ? window->parent.window : NULL)
+  {
+    if (window->is_cached) return true;
+  }
+
+  return false;
+}
+
+/*
+ * Get draw list that window drawings are recorded in, or NULL if it has a texture
+ */
+static inline gui_draw_list_t* gui_window_draw_list_get(gui_window_t* window)
+{
+  return gui_window_is_textured(window) ? NULL : &window->draw_list;
+}
+
+/*
+ * Get draw list that menu drawings are recorded in, or NULL if it has a texture
+ */
+static inline gui_draw_list_t* gui_menu_draw_list_get(gui_menu_t* menu)
+{
+  return (menu->gui->composite == GUI_COMPOSITE_DIRECT) ? &menu->draw_list : NULL;
+}
+
+/*
+ * Only destroy window (This is an internal function)
+ */
+static inline void _gui_window_destroy(gui_window_t** window)
+{
+  if (!window || !(*window)) return;
+
+  for (size_t index = 0; index < (*window)->child_count; index++)
+  {
+    _gui_window_destroy(&(*window)->children[index]);
+  }
+
+  free((*window)->children);
+
+  gui_grid_free(&(*window)->grid);
+
+  gui_draw_list_free(&(*window)->draw_list);
+
+  if ((*window)->gui)
+  {
+    gui_hover_forget((*window)->gui, *window);
+
+    gui_target_texture_destroy((*window)->gui, &(*window)->texture);
+  }
+
+  sdl_texture_destroy(&(*window)->texture);
+
+  free(*window);
+
+  *window = NULL;
+}
+
+/*
+ * Get menu window by name
+ */
+static inline gui_window_t* gui_menu_window_get(gui_menu_t* menu, const char* name)
+{
+  if (!menu || !name)
+  {
+    return NULL;
+  }
+
+  for (ssize_t index = 0; index < menu->window_count; index++)
+  {
+    gui_window_t* window = menu->windows[index];
+
+    if (window && strcmp(window->name, name) == 0)
+    {
+      return window;
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * Get index of menu window by name
+ */
+static inline ssize_t gui_menu_window_index_get(gui_menu_t* menu, const char* name)
+{
+  if (!menu || !name)
+  {
+    return -1;
+  }
+
+  for (ssize_t index = 0; index < menu->window_count; index++)
+  {
+    gui_window_t* window = menu->windows[index];
+
+    if (window && strcmp(window->name, name) == 0)
+    {
+      return index;
+    }
+  }
+
+  return -1;
+}
+
+/*
+ * Get index of window child by name
+ */
+static inline ssize_t gui_window_child_index_get(gui_window_t* window, const char* name)
+{
+  if (!window || !name)
+  {
+    return -1;
+  }
+
+  for (ssize_t index = 0; index < window->child_count; index++)
+  {
+    gui_window_t* child = window->children[index];
+
+    if (child && strcmp(child->name, name) == 0)
+    {
+      return index;
+    }
+  }
+
+  return -1;
+}
+
+/*
+ * Get window child by name
+ */
+static inline gui_window_t* gui_window_child_get(gui_window_t* window, const char* name)
+{
+  if (!window || !name)
+  {
+    return NULL;
+  }
+
+  for (ssize_t index = 0; index < window->child_count; index++)
+  {
+    gui_window_t* child = window->children[index];
+
+    if (child && strcmp(child->name, name) == 0)
+    {
+      return child;
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * Remove child from window and destroy it
+ */
+int gui_window_child_destroy(gui_window_t* window, char* name)
+{
+  if (!window || !name)
+  {
+    return 1;
+  }
+
+  ssize_t child_index = gui_window_child_index_get(window, name);
+
+  if (child_index == -1)
+  {
+    return 2;
+  }
+
+  gui_window_damage(window, window->children[child_index]->sdl_rect);
+
+  _gui_window_destroy(&window->children[child_index]);
+
+
+  for (size_t index = child_index; index < (window->child_count - 1); index++)
+  {
+    window->children[index] = window->children[index + 1];
+  }
+
+  window->child_count--;
+
+  gui_grid_invalidate(&window->grid);
+
+
+  gui_window_t** temp_children = realloc(window->children, sizeof(gui_window_t*) * window->child_count);
+
+  if (!temp_children)
+  {
+    // Here, the child is destroyed, but the children array isn't shrunk
+    return 3;
+  }
+
+  window->children = temp_children;
+
+  return 0;
+}
+
+/*
+ * Render loaded texture to target texture, or record it in draw list if there is one
+ */
+static inline int gui_draw_sprite_render(gui_t* gui, SDL_Texture* target, gui_draw_list_t* list, gui_texture_t* texture, SDL_Rect* rect)
+{
+  if (!list)
+  {
+    return gui_target_sprite_render(gui, target, texture, rect);
+  }
+
+  return gui_draw_list_append(list, (gui_draw_t) { .kind = GUI_DRAW_TEXTURE, .name = texture->name, .rect = *rect });
+}
+
+/*
+ * Render loaded texture (name) to window texture
+ */
+int gui_window_texture_render(gui_window_t* window, char* name, gui_rect_t gui_rect)
+{
+  if (!window || !name)
+  {
+    return 1;
+  }
+
+  gui_t* gui = window->gui;
+
+  if (!gui)
+  {
+    return 2;
+  }
+
+  SDL_Renderer* renderer = gui->renderer;
+
+  if (!renderer)
+  {
+    return 3;
+  }
+
+  gui_texture_t* gui_texture = gui_texture_get(gui, name);
+  
+  if (!gui_texture)
+  {
+    return 4;
+  }
+
+  SDL_Rect sdl_rect = sdl_rect_create(gui_rect, window->sdl_rect.w, window->sdl_rect.h);
+
+  if (gui_draw_sprite_render(gui, window->texture, gui_window_draw_list_get(window), gui_texture, &sdl_rect) != 0)
+  {
+    return 5;
+  }
+
+  gui_window_damage(window, sdl_rect);
+
+  return 0;
+}
+
+/*
+ * Render loaded texture (handle) to window texture
+ */
+int gui_window_texture_handle_render(gui_window_t* window, gui_handle_t handle, gui_rect_t gui_rect)
+{
+  if (!window)
+  {
+    return 1;
+  }
+
+  gui_t* gui = window->gui;
+
+  if (!gui)
+  {
+    return 2;
+  }
+
+  SDL_Renderer* renderer = gui->renderer;
+
+  if (!renderer)
+  {
+    return 3;
+  }
+
+  gui_texture_t* gui_texture = gui_handle_texture_get(gui, handle);
+
+  if (!gui_texture)
+  {
+    return 4;
+  }
+
+  SDL_Rect sdl_rect = sdl_rect_create(gui_rect, window->sdl_rect.w, window->sdl_rect.h);
+
+  if (gui_draw_sprite_render(gui, window->texture, gui_window_draw_list_get(window), gui_texture, &sdl_rect) != 0)
+  {
+    return 5;
+  }
+
+  gui_window_damage(window, sdl_rect);
+
+  return 0;
+}
+
+/*
+ * Render text to target texture, with the active text engine
+ *
+ * The text keeps its aspect ratio inside of gui_rect,
+ * the area that was rendered to is stored in rect
+ */
+static inline int gui_target_text_render(gui_t* gui, SDL_Texture* target, gui_font_t* font, gui_text_t text, gui_rect_t gui_rect, int parent_width, int parent_height, SDL_Rect* rect)
+{
+  int textw;
+  int texth;
+
+  if (gui->text_engine == GUI_TEXT_ENGINE_ATLAS)
+  {
+    gui_glyph_atlas_t* atlas = gui_font_atlas_get(gui, font);
+
+    if (atlas && gui_glyph_atlas_text_load(atlas, gui->renderer, font->font, text.text) == 0 &&
+        gui_glyph_atlas_text_size(atlas, text.text, &textw, &texth) == 0)
+    {
+      gui_rect.aspect_ratio = (float) textw / (float) texth;
+
+      SDL_Rect sdl_rect = sdl_rect_create(gui_rect, parent_width, parent_height);
+
+      if (gui_glyph_atlas_text_render(atlas, gui, target, text.text, text.color, sdl_rect) == 0)
+      {
+        *rect = sdl_rect;
+
+        return 0;
+      }
+    }
+
+    // Fall back on the text cache, for example if SDL_RenderGeometry is missing
+  }
+
+  SDL_Texture* texture = gui_text_texture_get(gui, font, text, &textw, &texth);
+
+  if (!texture)
+  {
+    return 1;
+  }
+
+  gui_rect.aspect_ratio = (float) textw / (float) texth;
+
+  SDL_Rect sdl_rect = sdl_rect_create(gui_rect, parent_width, parent_height);
+
+  if (gui_target_texture_render(gui, target, texture, &sdl_rect) != 0)
+  {
+    return 2;
+  }
+
+  *rect = sdl_rect;
+
+  return 0;
+}
+
+/*
+ * Render text to target texture, or record it in draw list if there is one
+ *
+ * A recorded text is laid out when it is replayed, so rect is
+ * the whole gui_rect instead of the area that is rendered to
+ */
+static inline int gui_draw_text_render(gui_t* gui, SDL_Texture* target, gui_draw_list_t* list, gui_font_t* font, gui_text_t text, gui_rect_t gui_rect, int parent_width, int parent_height, SDL_Rect* rect)
+{
+  if (!list)
+  {
+    return gui_target_text_render(gui, target, font, text, gui_rect, parent_width, parent_height, rect);
+  }
+
+  *rect = sdl_rect_create(gui_rect, parent_width, parent_height);
+
+  return gui_draw_list_append(list, (gui_draw_t) { .kind = GUI_DRAW_TEXT, .name = font->name, .text = text.text, .color = text.color, .gui_rect = gui_rect });
+}
+
+/*
+ * Replay the drawings of draw list to target texture
+ *
+ * Assets that have been removed since they were drawn are skipped
+ */
+static inline int gui_draw_list_render(gui_t* gui, SDL_Texture* target, gui_draw_list_t* list, int width, int height)
+{
+  for (size_t index = 0; index < list->count; index++)
+  {
+    gui_draw_t* draw = &list->draws[index];
+
+    if (draw->kind == GUI_DRAW_TEXTURE)
+    {
+      gui_texture_t* texture = gui_texture_get(gui, draw->name);
+
+      if (texture && gui_target_sprite_render(gui, target, texture, &draw->rect) != 0)
+      {
+        return 1;
+      }
+    }
+    else if (draw->kind == GUI_DRAW_TEXT)
+    {
+      gui_font_t* font = gui_font_get(gui, draw->name);
+
+      gui_text_t text = { .text = draw->text, .font = draw->name, .color = draw->color };
+
+      SDL_Rect rect;
+
+      if (font && gui_target_text_render(gui, target, font, text, draw->gui_rect, width, height, &rect) != 0)
+      {
+        return 2;
+      }
+    }
+    else if (draw->kind == GUI_DRAW_BORDER)
+    {
+      if (gui_target_border_render(gui, target, draw->border, draw->rect) != 0)
+      {
+        return 3;
+      }
+    }
+
+    gui->stats.direct_draw_count++;
+  }
+
+  return 0;
+}
+
+/*
+ *
+ */
+static inline int gui_window_text_render(gui_window_t* window, gui_text_t text, gui_rect_t gui_rect)
+{
+  if (!window || !text.text || !text.font)
+  {
+    return 1;
+  }
+
+  gui_t* gui = window->gui;
+
+  if (!gui)
+  {
+    return 2;
+  }
+
+  SDL_Renderer* renderer = gui->renderer;
+
+  if (!renderer)
+  {
+    return 3;
+  }
+
+  gui_font_t* gui_font = gui_font_get(gui, text.font);
+  
+  if (!gui_font)
+  {
+    return 4;
+  }
+
+  SDL_Rect sdl_rect;
+
+  int status = gui_draw_text_render(gui, window->texture, gui_window_draw_list_get(window), gui_font, text, gui_rect, window->sdl_rect.w, window->sdl_rect.h, &sdl_rect);
+
+  if (status != 0)
+  {
+    return 4 + status;
+  }
+
+  gui_window_damage(window, sdl_rect);
+
+  return 0;
+}
+
+/*
+ *
+ */
+static inline int gui_menu_text_render(gui_menu_t* menu, gui_text_t text, gui_rect_t gui_rect)
+{
+  if (!menu || !text.text || !text.font)
+  {
+    return 1;
+  }
+
+  gui_t* gui = menu->gui;
+
+  if (!gui)
+  {
+    return 2;
+  }
+
+  SDL_Renderer* renderer = gui->renderer;
+
+  if (!renderer || (!gui_menu_draw_list_get(menu) && !gui_menu_target_get(menu)))
+  {
+    return 3;
+  }
+
+  gui_font_t* gui_font = gui_font_get(gui, text.font);
+  
+  if (!gui_font)
+  {
+    return 4;
+  }
+
+  SDL_Rect sdl_rect;
+
+  menu->has_drawing = true;
+
+  int status = gui_draw_text_render(gui, menu->texture, gui_menu_draw_list_get(menu), gui_font, text, gui_rect, gui->width, gui->height, &sdl_rect);
+
+  if (status != 0)
+  {
+    return 4 + status;
+  }
+
+  gui_menu_damage(menu, sdl_rect);
+
+  return 0;
+}
+
+/*
+ * Render text with loaded font (handle) to window texture
+ */
+int gui_window_text_handle_render(gui_window_t* window, gui_handle_t font, char* text, gui_color_t color, gui_rect_t gui_rect)
+{
+  if (!window || !text)
+  {
+    return 1;
+  }
+
+  gui_t* gui = window->gui;
+
+  if (!gui)
+  {
+    return 2;
+  }
+
+  if (!gui->renderer)
+  {
+    return 3;
+  }
+
+  gui_font_t* gui_font = gui_handle_font_get(gui, font);
+
+  if (!gui_font)
+  {
+    return 4;
+  }
+
+  gui_text_t gui_text = { .text = text, .font = gui_font->name, .color = color };
+
+  SDL_Rect sdl_rect;
+
+  int status = gui_draw_text_render(gui, window->texture, gui_window_draw_list_get(window), gui_font, gui_text, gui_rect, window->sdl_rect.w, window->sdl_rect.h, &sdl_rect);
+
+  if (status != 0)
+  {
+    return 4 + status;
+  }
+
+  gui_window_damage(window, sdl_rect);
+
+  return 0;
+}
+
+/*
+ * Render text with loaded font (handle) to menu texture
+ */
+int gui_menu_text_handle_render(gui_menu_t* menu, gui_handle_t font, char* text, gui_color_t color, gui_rect_t gui_rect)
+{
+  if (!menu || !text)
+  {
+    return 1;
+  }
+
+  gui_t* gui = menu->gui;
+
+  if (!gui)
+  {
+    return 2;
+  }
+
+  if (!gui->renderer || (!gui_menu_draw_list_get(menu) && !gui_menu_target_get(menu)))
+  {
+    return 3;
+  }
+
+  gui_font_t* gui_font = gui_handle_font_get(gui, font);
+
+  if (!gui_font)
+  {
+    return 4;
+  }
+
+  gui_text_t gui_text = { .text = text, .font = gui_font->name, .color = color };
+
+  SDL_Rect sdl_rect;
+
+  menu->has_drawing = true;
+
+  int status = gui_draw_text_render(gui, menu->texture, gui_menu_draw_list_get(menu), gui_font, gui_text, gui_rect, gui->width, gui->height, &sdl_rect);
+
+  if (status != 0)
+  {
+    return 4 + status;
+  }
+
+  gui_menu_damage(menu, sdl_rect);
+
+  return 0;
+}
+
+/*
+ * Remove window from menu and destroy it
+ */
+int gui_menu_window_destroy(gui_menu_t* menu, char* name)
+{
+  if (!menu || !name)
+  {
+    return 1;
+  }
+
+  ssize_t window_index = gui_menu_window_index_get(menu, name);
+
+  if (window_index == -1)
+  {
+    return 2;
+  }
+
+  gui_window_t* window = menu->windows[window_index];
+
+  gui_menu_damage(menu, sdl_border_rect_get(window->border, window->sdl_rect));
+
+  _gui_window_destroy(&menu->windows[window_index]);
+
+
+  for (size_t index = window_index; index < (menu->window_count - 1); index++)
+  {
+    menu->windows[index] = menu->windows[index + 1];
+  }
+
+  menu->window_count--;
+
+  gui_grid_invalidate(&menu->grid);
+
+
+  gui_window_t** temp_windows = realloc(menu->windows, sizeof(gui_window_t*) * menu->window_count);
+
+  if (!temp_windows)
+  {
+    // Here, the window is destroyed, but the windows array isn't shrunk
+    return 3;
+  }
+
+  menu->windows = temp_windows;
+
+  return 0;
+}
+
+/*
+ * Create window and add it to menu
+ */
+gui_window_t* gui_menu_window_create(gui_menu_t* menu, char* name, gui_rect_t gui_rect, gui_border_t border)
+{
+  if (!menu || !name)
+  {
+    return NULL;
+  }
+
+  gui_t* gui = menu->gui;
+
+  if (!gui)
+  {
+    return NULL;
+  }
+
+  gui_window_t* window = malloc(sizeof(gui_window_t));
+
+  if (!window)
+  {
+    return NULL;
+  }
+
+  memset(window, 0, sizeof(gui_window_t));
+
+  window->name = name;
+  window->gui  = gui;
+
+  window->border = border;
+
+  window->is_child = false;
+  window->parent.menu = menu;
+
+  window->gui_rect = gui_rect;
+
+  window->sdl_rect = sdl_rect_create(window->gui_rect, gui->width, gui->height);
+
+  if (gui_window_is_textured(window))
+  {
+    window->texture = gui_target_texture_create(gui, window->sdl_rect.w, window->sdl_rect.h);
+
+    if (!window->texture)
+    {
+      free(window);
+
+      return NULL;
+    }
+  }
+
+
+  gui_window_t** temp_windows = realloc(menu->windows, sizeof(gui_window_t*) * (menu->window_count + 1));
+
+  if (!temp_windows)
+  {
+    _gui_window_destroy(&window);
+
+    return NULL;
+  }
+
+  menu->windows = temp_windows;
+
+  menu->windows[menu->window_count++] = window;
+
+  gui_grid_window_append(&menu->grid, menu->windows, menu->window_count);
+
+  gui->is_hover_cached = false;
+
+  gui_window_damage_all(window);
+
+  return window;
+}
+
+/*
+ * Create child window and add it to window
+ */
+gui_window_t* gui_window_child_create(gui_window_t* window, char* name, gui_rect_t gui_rect)
+{
+  if (!window || !name)
+  {
+    return NULL;
+  }
+
+  gui_t* gui = window->gui;
+
+  if (!gui)
+  {
+    return NULL;
+  }
+
+  gui_window_t* child = malloc(sizeof(gui_window_t));
+
+  if (!child)
+  {
+    return NULL;
+  }
+
+  memset(child, 0, sizeof(gui_window_t));
+
+  child->name = name;
+  child->gui  = gui;
+
+  child->is_child = true;
+  child->parent.window = window;
+
+  child->gui_rect = gui_rect;
+
+  child->sdl_rect = sdl_rect_create(child->gui_rect, window->sdl_rect.w, window->sdl_rect.h);
+
+  if (gui_window_is_textured(child))
+  {
+    child->texture = gui_target_texture_create(gui, child->sdl_rect.w, child->sdl_rect.h);
+
+    if (!child->texture)
+    {
+      free(child);
+
+      return NULL;
+    }
+  }
+
+
+  gui_window_t** temp_children = realloc(window->children, sizeof(gui_window_t*) * (window->child_count + 1));
+
+  if (!temp_children)
+  {
+    _gui_window_destroy(&child);
+
+    return NULL;
+  }
+
+  window->children = temp_children;
+
+  window->children[window->child_count++] = child;
+
+  gui_grid_window_append(&window->grid, window->children, window->child_count);
+
+  gui->is_hover_cached = false;
+
+  gui_window_damage_all(child);
+
+  return child;
+}
+
+/*
+ * Occlusion
+ */
+
+/*
+ * Append the pieces of part, that are outside of cover, to parts
+ *
+ * false is returned if the pieces don't fit in parts
+ */
+static inline bool sdl_rect_subtract(SDL_Rect part, SDL_Rect cover, SDL_Rect* parts, size_t* count)
+{
+  SDL_Rect pieces[4] = { part };
+
+  SDL_Rect inside;
+
+  if (SDL_IntersectRect(&part, &cover, &inside))
+  {
+    pieces[0] = (SDL_Rect) { part.x, part.y, part.w, inside.y - part.y };
+    pieces[1] = (SDL_Rect) { part.x, inside.y + inside.h, part.w, part.y + part.h - inside.y - inside.h };
+    pieces[2] = (SDL_Rect) { part.x, inside.y, inside.x - part.x, inside.h };
+    pieces[3] = (SDL_Rect) { inside.x + inside.w, inside.y, part.x + part.w - inside.x - inside.w, inside.h };
+  }
+
+  for (int index = 0; index < 4; index++)
+  {
+    if (pieces[index].w <= 0 || pieces[index].h <= 0) continue;
+
+    if (*count == GUI_COVER_PART_COUNT)
+    {
+      return false;
+    }
+
+    parts[(*count)++] = pieces[index];
+  }
+
+  return true;
+}
+
+/*
+ * Check if rect is covered by the opaque ones of windows
+ *
+ * The uncovered parts of rect are cut by every opaque window. If there
+ * are too many parts to follow, rect is taken as not covered
+ */
+static inline bool gui_windows_cover_check(gui_window_t** windows, size_t count, size_t opaque_count, SDL_Rect rect)
+{
+  SDL_Rect parts[GUI_COVER_PART_COUNT] = { rect };
+
+  size_t part_count = 1;
+
+  for (size_t index = 0; index < count && opaque_count > 0 && part_count > 0; index++)
+  {
+    gui_window_t* window = windows[index];
+
+    if (!window->is_opaque) continue;
+
+    opaque_count--;
+
+    SDL_Rect next_parts[GUI_COVER_PART_COUNT];
+
+    size_t next_count = 0;
+
+    for (size_t part = 0; part < part_count; part++)
+    {
+      if (!sdl_rect_subtract(parts[part], window->sdl_rect, next_parts, &next_count))
+      {
+        return false;
+      }
+    }
+
+    memcpy(parts, next_parts, sizeof(SDL_Rect) * next_count);
+
+    part_count = next_count;
+  }
+
+  return (part_count == 0);
+}
+
+/*
+ * Count the opaque ones of windows
+ */
+static inline size_t gui_windows_opaque_count(gui_window_t** windows, size_t count)
+{
+  size_t opaque_count = 0;
+
+  for (size_t index = 0; index < count; index++)
+  {
+    if (windows[index]->is_opaque) opaque_count++;
+  }
+
+  return opaque_count;
+}
+
+/*
+ * Check if a window with bounds can be skipped, because it is outside
+ * of clip, or covered by the opaque ones of the windows above it
+ */
+static inline bool gui_window_cull_check(gui_t* gui, SDL_Rect bounds, SDL_Rect clip, gui_window_t** windows, size_t count, size_t opaque_count)
+{
+  SDL_Rect visible;
+
+  if (!SDL_IntersectRect(&bounds, &clip, &visible) ||
+      (opaque_count > 0 && gui_windows_cover_check(windows, count, opaque_count, visible)))
+  {
+    gui->stats.culled_count++;
+
+    return true;
+  }
+
+  return false;
+}
+
+/*
+ * Mark window as opaque, so that the windows below it can be culled
+ *
+ * Only set this if the drawings of window fill all of it
+ */
+int gui_window_opaque_set(gui_window_t* window, bool is_opaque)
+{
+  if (!window)
+  {
+    return 1;
+  }
+
+  if (window->is_opaque == is_opaque) return 0;
+
+  window->is_opaque = is_opaque;
+
+  // The windows below are composited again, if they were culled
+  gui_window_parent_damage(window, window->sdl_rect);
+
+  return 0;
+}
+
+/*
+ * Render window with all of it's child windows
+ *
+ * Only children that have changed, or that overlap
+ * the changed area of the window, are composited again.
+ * Children that are covered or outside of the window are culled
+ */
+static inline int gui_window_render(gui_window_t* window)
+{
+  if (!window)
+  {
+    return 1;
+  }
+
+  gui_t* gui = window->gui;
+
+  if (!gui)
+  {
+    return 2;
+  }
+
+  SDL_Renderer* renderer = gui->renderer;
+
+  if (!renderer)
+  {
+    return 3;
+  }
+
+  SDL_Rect clip = { 0, 0, window->sdl_rect.w, window->sdl_rect.h };
+
+  size_t opaque_count = gui_windows_opaque_count(window->children, window->child_count);
+
+  for (size_t index = 0; index < window->child_count; index++)
+  {
+    gui_window_t* child = window->children[index];
+
+    // Only the opaque windows above the child are counted
+    if (child->is_opaque) opaque_count--;
+
+    if (!child->is_dirty && !SDL_HasIntersection(&child->sdl_rect, &window->damage))
+    {
+      continue;
+    }
+
+    if (gui_window_cull_check(gui, child->sdl_rect, clip, &window->children[index + 1], window->child_count - index - 1, opaque_count))
+    {
+      continue;
+    }
+
+    // The whole child is composited, so the children above it have to be too
+    SDL_UnionRect(&window->damage, &child->sdl_rect, &window->damage);
+
+    if (gui_window_render(child) != 0)
+    {
+      return 4;
+    }
+
+    if (gui_target_part_render(gui, window->texture, child->texture, child->sdl_rect.w, child->sdl_rect.h, &child->sdl_rect) != 0)
+    {
+      return 5;
+    }
+
+    gui->stats.composite_count++;
+  }
+
+  window->is_dirty = false;
+  window->damage   = (SDL_Rect) { 0 };
+
+  return 0;
+}
+
+/*
+ * Menu
+ */
+
+/*
+ * Set the preload group of menu, a NULL terminated list of texture names
+ *
+ * The textures of the group are loaded before the menu is shown
+ */
+int gui_menu_preload_set(gui_t* gui, char* menu_name, char** texture_names)
+{
+  gui_menu_t* menu = gui_menu_get(gui, menu_name);
+
+  if (!menu || !texture_names)
+  {
+    return 1;
+  }
+
+  size_t count = 0;
+
+  while (texture_names[count]) count++;
+
+  char** names = malloc(sizeof(char*) * MAX(count, 1));
+
+  if (!names)
+  {
+    return 2;
+  }
+
+  memcpy(names, texture_names, sizeof(char*) * count);
+
+  free(menu->preload_names);
+
+  menu->preload_names = names;
+  menu->preload_count = count;
+
+  return 0;
+}
+
+/*
+ * Get the registered textures of preload group, that are not loaded yet
+ */
+static inline size_t gui_menu_preload_assets_get(gui_t* gui, gui_menu_t* menu, gui_asset_t* assets)
+{
+  gui_assets_t* gui_assets = gui->assets;
+
+  size_t count = 0;
+
+  for (size_t index = 0; index < menu->preload_count; index++)
+  {
+    ssize_t texture_index = gui_name_index_get(&gui_assets->texture_index, menu->preload_names[index]);
+
+    if (texture_index == -1) continue;
+
+    gui_texture_t* texture = gui_assets->textures[texture_index];
+
+    if (!texture->texture && texture->filepath && !texture->load_failed)
+    {
+      assets[count++] = (gui_asset_t) { texture->name, texture->filepath };
+    }
+  }
+
+  return count;
+}
+
+/*
+ * Start loading the preload group of menu in the background
+ *
+ * Call it ahead of gui_active_menu_set, for example when the button
+ * that opens the menu is hovered. GUI_TICKET_NONE is returned
+ * if there is nothing to load
+ */
+gui_ticket_t gui_menu_preload(gui_t* gui, char* menu_name)
+{
+  gui_menu_t* menu = gui_menu_get(gui, menu_name);
+
+  if (!menu || menu->preload_count == 0)
+  {
+    return GUI_TICKET_NONE;
+  }
+
+  if (!gui_load_is_done(gui, menu->preload_ticket))
+  {
+    return menu->preload_ticket;
+  }
+
+  gui_asset_t* assets = malloc(sizeof(gui_asset_t) * menu->preload_count);
+
+  if (!assets)
+  {
+    return GUI_TICKET_NONE;
+  }
+
+  size_t count = gui_menu_preload_assets_get(gui, menu, assets);
+
+  if (count > 0)
+  {
+    menu->preload_ticket = gui_textures_load_async(gui, assets, count);
+  }
+  else menu->preload_ticket = GUI_TICKET_NONE;
+
+  free(assets);
+
+  return menu->preload_ticket;
+}
+
+/*
+ * Finish loading the preload group of menu, before it is shown
+ */
+static inline void gui_menu_preload_finish(gui_t* gui, gui_menu_t* menu)
+{
+  if (menu->preload_count == 0) return;
+
+  gui_load_wait(gui, menu->preload_ticket);
+
+  menu->preload_ticket = GUI_TICKET_NONE;
+
+  gui_asset_t* assets = malloc(sizeof(gui_asset_t) * menu->preload_count);
+
+  if (!assets) return;
+
+  // The textures that weren't preloaded are loaded with the worker pool
+  size_t count = gui_menu_preload_assets_get(gui, menu, assets);
+
+  if (count > 0)
+  {
+    gui_textures_load(gui, assets, count);
+  }
+
+  free(assets);
+}
+
+/*
+ * Render menu with all of it's windows and child windows
+ *
+ * Only windows that have changed, or that overlap the changed area
+ * of the menu, are composited again. The rest of the menu texture
+ * is kept from the last frame
+ *
+ * The for-loop decides which order to render the windows
+ */
+static inline int gui_menu_render(gui_menu_t* menu)
+{
+  if (!menu)
+  {
+    return 1;
+  }
+
+  gui_t* gui = menu->gui;
+
+  if (!gui)
+  {
+    return 2;
+  }
+
+  SDL_Renderer* renderer = gui->renderer;
+
+  if (!renderer || !gui_menu_target_get(menu))
+  {
+    return 3;
+  }
+
+  SDL_Rect clip = { 0, 0, gui->width, gui->height };
+
+  size_t opaque_count = gui_windows_opaque_count(menu->windows, menu->window_count);
+
+  for (size_t index = 0; index < menu->window_count; index++)
+  {
+    gui_window_t* window = menu->windows[index];
+
+    // Only the opaque windows above the window are counted
+    if (window->is_opaque) opaque_count--;
+
+    SDL_Rect bounds = sdl_border_rect_get(window->border, window->sdl_rect);
+
+    if (!window->is_dirty && !SDL_HasIntersection(&bounds, &menu->damage))
+    {
+      continue;
+    }
+
+    if (gui_window_cull_check(gui, bounds, clip, &menu->windows[index + 1], menu->window_count - index - 1, opaque_count))
+    {
+      continue;
+    }
+
+    // The whole window is composited, so the windows above it have to be too
+    SDL_UnionRect(&menu->damage, &bounds, &menu->damage);
+
+    if (gui_window_render(window) != 0)
+    {
+      return 4;
+    }
+
+    if (gui_target_part_render(gui, menu->texture, window->texture, window->sdl_rect.w, window->sdl_rect.h, &window->sdl_rect) != 0)
+    {
+      return 5;
+    }
+
+    if (gui_target_border_render(gui, menu->texture, window->border, window->sdl_rect) != 0)
+    {
+      return 6;
+    }
+
+    gui->stats.composite_count++;
+  }
+
+  menu->damage = (SDL_Rect) { 0 };
+
+  return 0;
+}
+
+/*
+ * Direct rendering
+ */
+
+/*
+ * Set viewport and clip rect of the screen, clip is in screen coordinates
+ *
+ * Switching target resets both, so the screen is made the target first.
+ * The batched sprites are drawn before, because they are in the old viewport
+ */
+static inline int gui_viewport_set(gui_t* gui, SDL_Rect* viewport, SDL_Rect* clip)
+{
+  if (gui_target_set(gui, NULL) != 0)
+  {
+    return 1;
+  }
+
+  if (SDL_RenderSetViewport(gui->renderer, viewport) != 0)
+  {
+    fprintf(stderr, "SDL_RenderSetViewport: %s\n", SDL_GetError());
+
+    return 2;
+  }
+
+  SDL_Rect local;
+
+  if (clip)
+  {
+    // The clip rect is relative to the viewport
+    local = (SDL_Rect) { clip->x, clip->y, clip->w, clip->h };
+
+    if (viewport)
+    {
+      local.x -= viewport->x;
+      local.y -= viewport->y;
+    }
+  }
+
+  if (SDL_RenderSetClipRect(gui->renderer, clip ? &local : NULL) != 0)
+  {
+    fprintf(stderr, "SDL_RenderSetClipRect: %s\n", SDL_GetError());
+
+    return 3;
+  }
+
+  return 0;
+}
+
+/*
+ * Render window with all of it's child windows straight to the screen
+ *
+ * origin is the position of the parent on the screen, and clip
+ * is the area of the screen that the parent is visible in.
+ * A cached window is composited from its texture instead
+ */
+static inline int gui_window_direct_render(gui_window_t* window, SDL_Point origin, SDL_Rect clip)
+{
+  gui_t* gui = window->gui;
+
+  SDL_Rect rect = { origin.x + window->sdl_rect.x, origin.y + window->sdl_rect.y, window->sdl_rect.w, window->sdl_rect.h };
+
+  SDL_Rect visible;
+
+  if (!SDL_IntersectRect(&rect, &clip, &visible))
+  {
+    return 0;
+  }
+
+  if (window->texture)
+  {
+    if (gui_window_render(window) != 0)
+    {
+      return 1;
+    }
+
+    if (gui_viewport_set(gui, NULL, &visible) != 0)
+    {
+      return 2;
+    }
+
+    if (gui_target_part_render(gui, NULL, window->texture, window->sdl_rect.w, window->sdl_rect.h, &rect) != 0)
+    {
+      return 3;
+    }
+
+    gui->stats.composite_count++;
+
+    return 0;
+  }
+
+  if (gui_viewport_set(gui, &rect, &visible) != 0)
+  {
+    return 4;
+  }
+
+  // A window is opaque black under its drawings, like a cleared window texture
+  if (gui_draw_color_set(gui, (SDL_Color) { 0, 0, 0, 255 }) != 0)
+  {
+    return 5;
+  }
+
+  SDL_RenderFillRect(gui->renderer, &(SDL_Rect) { 0, 0, rect.w, rect.h });
+
+  if (gui_draw_list_render(gui, NULL, &window->draw_list, rect.w, rect.h) != 0)
+  {
+    return 6;
+  }
+
+  SDL_Rect local = { 0, 0, rect.w, rect.h };
+
+  size_t opaque_count = gui_windows_opaque_count(window->children, window->child_count);
+
+  for (size_t index = 0; index < window->child_count; index++)
+  {
+    gui_window_t* child = window->children[index];
+
+    if (child->is_opaque) opaque_count--;
+
+    if (gui_window_cull_check(gui, child->sdl_rect, local, &window->children[index + 1], window->child_count - index - 1, opaque_count))
+    {
+      continue;
+    }
+
+    if (gui_window_direct_render(child, (SDL_Point) { rect.x, rect.y }, visible) != 0)
+    {
+      return 7;
+    }
+  }
+
+  window->is_dirty = false;
+  window->damage   = (SDL_Rect) { 0 };
+
+  return 0;
+}
+
+/*
+ * Render menu with all of it's windows straight to the screen
+ *
+ * Every window is drawn again, because the back buffer
+ * is undefined after it has been presented
+ */
+static inline int gui_menu_direct_render(gui_menu_t* menu)
+{
+  gui_t* gui = menu->gui;
+
+  SDL_Rect screen = { 0, 0, gui->width, gui->height };
+
+  if (gui_viewport_set(gui, NULL, NULL) != 0 || gui_target_clear(gui, NULL) != 0)
+  {
+    return 1;
+  }
+
+  if (gui_draw_list_render(gui, NULL, &menu->draw_list, gui->width, gui->height) != 0)
+  {
+    return 2;
+  }
+
+  size_t opaque_count = gui_windows_opaque_count(menu->windows, menu->window_count);
+
+  for (size_t index = 0; index < menu->window_count; index++)
+  {
+    gui_window_t* window = menu->windows[index];
+
+    if (window->is_opaque) opaque_count--;
+
+    SDL_Rect bounds = sdl_border_rect_get(window->border, window->sdl_rect);
+
+    if (gui_window_cull_check(gui, bounds, screen, &menu->windows[index + 1], menu->window_count - index - 1, opaque_count))
+    {
+      continue;
+    }
+
+    if (gui_window_direct_render(window, (SDL_Point) { 0, 0 }, screen) != 0)
+    {
+      return 3;
+    }
+
+    if (gui_viewport_set(gui, NULL, NULL) != 0)
+    {
+      return 4;
+    }
+
+    if (gui_target_border_render(gui, NULL, window->border, window->sdl_rect) != 0)
+    {
+      return 5;
+    }
+  }
+
+  // Draw the batched sprites, before the screen is presented
+  if (gui_target_set(gui, NULL) != 0)
+  {
+    return 6;
+  }
+
+  menu->damage = (SDL_Rect) { 0 };
+
+  return 0;
+}
+
+/*
+ * Create or drop the textures of window and its children,
+ * after the window has been cached or uncached
+ *
+ * The drawings of a window are replayed to its new texture,
+ * but a dropped texture takes its drawings with it
+ */
+static inline int gui_window_texture_update(gui_window_t* window)
+{
+  gui_t* gui = window->gui;
+
+  if (gui_window_is_textured(window) && !window->texture)
+  {
+    window->texture = gui_target_texture_create(gui, window->sdl_rect.w, window->sdl_rect.h);
+
+    if (!window->texture)
+    {
+      return 1;
+    }
+
+    if (gui_draw_list_render(gui, window->texture, &window->draw_list, window->sdl_rect.w, window->sdl_rect.h) != 0)
+    {
+      return 2;
+    }
+
+    gui_draw_list_free(&window->draw_list);
+  }
+  else if (!gui_window_is_textured(window) && window->texture)
+  {
+    gui_target_texture_destroy(gui, &window->texture);
+  }
+
+  gui_window_damage_all(window);
+
+  for (size_t index = 0; index < window->child_count; index++)
+  {
+    if (gui_window_texture_update(window->children[index]) != 0)
+    {
+      return 3;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Keep a texture for window and its children in direct mode
+ *
+ * A cached window is only drawn again when it has changed,
+ * which pays off for windows with many drawings that seldom change
+ */
+int gui_window_cached_set(gui_window_t* window, bool is_cached)
+{
+  if (!window)
+  {
+    return 1;
+  }
+
+  if (!window->gui)
+  {
+    return 2;
+  }
+
+  window->is_cached = is_cached;
+
+  if (gui_window_texture_update(window) != 0)
+  {
+    return 3;
+  }
+
+  return 0;
+}
+
+/*
+ * Set how windows are composited to the screen
+ *
+ * The mode can only be set before any menu is created,
+ * because it decides which windows have textures
+ */
+int gui_composite_mode_set(gui_t* gui, gui_composite_t mode)
+{
+  if (!gui)
+  {
+    return 1;
+  }
+
+  if (gui->menu_count > 0)
+  {
+    return 2;
+  }
+
+  gui->composite = mode;
+
+  return 0;
+}
+
+/*
+ *
+ */
+static inline SDL_Texture* gui_window_parent_texture_get(gui_window_t* window)
+{
+  if (window->is_child)
+  {
+    if (window->parent.window)
+    {
+      return window->parent.window->texture;
+    }
+  }
+  else
+  {
+    if (window->parent.menu)
+    {
+      window->parent.menu->has_drawing = true;
+
+      return gui_menu_target_get(window->parent.menu);
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * Get draw list of the parent of window, or NULL if the parent has a texture
+ */
+static inline gui_draw_list_t* gui_window_parent_draw_list_get(gui_window_t* window)
+{
+  if (window->is_child)
+  {
+    if (window->parent.window)
+    {
+      return gui_window_draw_list_get(window->parent.window);
+    }
+  }
+  else
+  {
+    if (window->parent.menu)
+    {
+      return gui_menu_draw_list_get(window->parent.menu);
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * Render border around window
+ */
+int gui_window_border_render(gui_window_t* window, gui_border_t border)
+{
+  if (!window)
+  {
+    return 1;
+  }
+
+  gui_t* gui = window->gui;
+
+  if (!gui)
+  {
+    return 2;
+  }
+
+  SDL_Renderer* renderer = gui->renderer;
+
+  if (!renderer)
+  {
+    return 3;
+  }
+
+  gui_draw_list_t* list = gui_window_parent_draw_list_get(window);
+
+  if (list)
+  {
+    if (gui_draw_list_append(list, (gui_draw_t) { .kind = GUI_DRAW_BORDER, .border = border, .rect = window->sdl_rect }) != 0)
+    {
+      return 4;
+    }
+  }
+  else
+  {
+    SDL_Texture* texture = gui_window_parent_texture_get(window);
+
+    if (!texture)
+    {
+      return 4;
+    }
+
+    if (gui_target_border_render(gui, texture, border, window->sdl_rect) != 0)
+    {
+      return 5;
+    }
+  }
+
+  gui_window_parent_damage(window, sdl_border_rect_get(border, window->sdl_rect));
+
+  return 0;
+}
+
+/*
+ *
+ */
+int gui_curr_window_border_render(gui_t* gui, gui_border_t border)
+{
+  return gui_window_border_render(gui->curr_window, border);
+}
+
+/*
+ *
+ */
+bool gui_window_name_check(gui_window_t* window, char* name)
+{
+  if (!window || !name) return false;
+
+  return (strcmp(window->name, name) == 0);
+}
+/*
+ *
+ */
+bool gui_curr_window_name_check(gui_t* gui, char* name)
+{
+  if (!gui || !name) return false;
+
+  return gui_window_name_check(gui->curr_window, name);
+}
+
+/*
+ * Render loaded texture (name) to menu texture
+ */
+int gui_menu_texture_render(gui_menu_t* menu, char* name, gui_rect_t gui_rect)
+{
+  if (!menu || !name)
+  {
+    return 1;
+  }
+
+  gui_t* gui = menu->gui;
+
+  if (!gui)
+  {
+    return 2;
+  }
+
+  SDL_Renderer* renderer = gui->renderer;
+
+  if (!renderer || (!gui_menu_draw_list_get(menu) && !gui_menu_target_get(menu)))
+  {
+    return 3;
+  }
+
+  gui_texture_t* gui_texture = gui_texture_get(gui, name);
+  
+  if (!gui_texture)
+  {
+    return 4;
+  }
+
+  SDL_Rect sdl_rect = sdl_rect_create(gui_rect, gui->width, gui->height);
+
+  menu->has_drawing = true;
+
+  if (gui_draw_sprite_render(gui, menu->texture, gui_menu_draw_list_get(menu), gui_texture, &sdl_rect) != 0)
+  {
+    return 5;
+  }
+
+  gui_menu_damage(menu, sdl_rect);
+
+  return 0;
+}
+
+/*
+ * Render loaded texture (handle) to menu texture
+ */
+int gui_menu_texture_handle_render(gui_menu_t* menu, gui_handle_t handle, gui_rect_t gui_rect)
+{
+  if (!menu)
+  {
+    return 1;
+  }
+
+  gui_t* gui = menu->gui;
+
+  if (!gui)
+  {
+    return 2;
+  }
+
+  SDL_Renderer* renderer = gui->renderer;
+
+  if (!renderer || (!gui_menu_draw_list_get(menu) && !gui_menu_target_get(menu)))
+  {
+    return 3;
+  }
+
+  gui_texture_t* gui_texture = gui_handle_texture_get(gui, handle);
+
+  if (!gui_texture)
+  {
+    return 4;
+  }
+
+  SDL_Rect sdl_rect = sdl_rect_create(gui_rect, gui->width, gui->height);
+
+  menu->has_drawing = true;
+
+  if (gui_draw_sprite_render(gui, menu->texture, gui_menu_draw_list_get(menu), gui_texture, &sdl_rect) != 0)
+  {
+    return 5;
+  }
+
+  gui_menu_damage(menu, sdl_rect);
+
+  return 0;
+}
+
+/*
+ * Events
+ */
+
+/*
+ * Names of built-in events, indexed by gui_event_id_t
+ */
+static const char* GUI_EVENT_NAMES[GUI_EVENT_COUNT] =
+{
+  "quit",
+  "resize",
+  "key-down",
+  "key-up",
+  "mouse-motion",
+  "mouse-down-left",
+  "mouse-down-right",
+  "mouse-up-left",
+  "mouse-up-right",
+  "window-enter",
+  "window-exit",
+  "frame",
+  "load-progress",
+  "load-done"
+};
+
+/*
+ * Get ID of event, -1 if it doesn't exist
+ */
+int gui_event_id_get(gui_t* gui, char* name)
+{
+  if (!gui || !name)
+  {
+    return -1;
+  }
+
+  return (int) gui_name_index_get(&gui->event_index, name);
+}
+
+/*
+ * Get event by ID
+ */
+static inline gui_event_t* gui_event_get(gui_t* gui, int id)
+{
+  if (id < 0 || (size_t) id >= gui->event_count)
+  {
+    return NULL;
+  }
+
+  return gui->events[id];
+}
+
+/*
+ * Destroy gui event and remove handlers
+ */
+static inline void gui_event_destroy(gui_event_t** event)
+{
+  if (!event || !(*event)) return;
+
+  free((*event)->handlers);
+
+  free(*event);
+
+  *event = NULL;
+}
+
+/*
+ * Destroy all gui events
+ */
+void gui_events_destroy(gui_event_t*** events, size_t count)
+{
+  for (size_t index = 0; index < count; index++)
+  {
+    gui_event_destroy(&(*events)[index]);
+  }
+
+  free(*events);
+
+  *events = NULL;
+}
+
+/*
+ * Add event without handlers and intern its name
+ *
+ * The ID of the event is returned, -1 on failure
+ */
+static inline int gui_event_add(gui_t* gui, char* name)
+{
+  gui_event_t* event = malloc(sizeof(gui_event_t));
+
+  if (!event)
+  {
+    return -1;
+  }
+
+  memset(event, 0, sizeof(gui_event_t));
+
+  event->name = name;
+
+  gui_event_t** temp_events = realloc(gui->events, sizeof(gui_event_t*) * (gui->event_count + 1));
+
+  if (!temp_events)
+  {
+    free(event);
+
+    return -1;
+  }
+
+  gui->events = temp_events;
+
+  if (gui_name_index_add(&gui->event_index, name, gui->event_count) != 0)
+  {
+    free(event);
+
+    return -1;
+  }
+
+  gui->events[gui->event_count] = event;
+
+  return (int) gui->event_count++;
+}
+
+/*
+ * Add built-in events, so that their IDs match gui_event_id_t
+ */
+static inline int gui_events_builtin_add(gui_t* gui)
+{
+  for (int id = 0; id < GUI_EVENT_COUNT; id++)
+  {
+    if (gui_event_add(gui, (char*) GUI_EVENT_NAMES[id]) != id)
+    {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Create event and assign handler
+ *
+ * The name of a new event is interned to an ID,
+ * so that triggering it doesn't compare any strings
+ */
+int gui_event_create(gui_t* gui, char* name, gui_event_handler_t handler)
+{
+  if (!gui || !name)
+  {
+    return 1;
+  }
+
+  int id = gui_event_id_get(gui, name);
+
+  if (id == -1)
+  {
+    id = gui_event_add(gui, name);
+
+    if (id == -1)
+    {
+      return 3;
+    }
+  }
+
+  gui_event_t* event = gui->events[id];
+
+  gui_event_handler_t* temp_handlers = realloc(event->handlers, sizeof(gui_event_handler_t) * (event->handler_count + 1));
+
+  if (!temp_handlers)
+  {
+    return 2;
+  }
+
+  event->handlers = temp_handlers;
+
+  event->handlers[event->handler_count++] = handler;
+
+  return 0;
+}
+
+/*
+ * Default event handler for quit event
+ */
+static inline void* _gui_event_quit_handle(gui_t* gui)
+{
+  gui->is_running = false;
+}
+
+/*
+ * Resize window texture and children
+ */
+static inline int gui_window_resize(gui_window_t* window, int width, int height)
+{
+  if (!window)
+  {
+    return 1;
+  }
+
+  gui_t* gui = window->gui;
+
+  if (!gui)
+  {
+    return 2;
+  }
+
+  window->sdl_rect = sdl_rect_create(window->gui_rect, width, height);
+
+  if (gui_window_is_textured(window) && gui_target_texture_resize(gui, &window->texture, window->sdl_rect.w, window->sdl_rect.h) != 0)
+  {
+    return 3;
+  }
+
+  window->is_dirty = true;
+  window->damage   = (SDL_Rect) { 0, 0, window->sdl_rect.w, window->sdl_rect.h };
+
+  gui_grid_invalidate(&window->grid);
+
+  gui->is_hover_cached = false;
+
+
+  for (size_t index = 0; index < window->child_count; index++)
+  {
+    gui_window_t* child = window->children[index];
+
+    if (gui_window_resize(child, window->sdl_rect.w, window->sdl_rect.h) != 0)
+    {
+      return 4;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Resize menu texture and windows within it
+ */
+static inline int gui_menu_resize(gui_menu_t* menu, int width, int height)
+{
+  if (!menu)
+  {
+    return 1;
+  }
+
+  gui_t* gui = menu->gui;
+
+  if (!gui)
+  {
+    return 2;
+  }
+
+  // The menu texture is created again with the new size, when it is used
+  gui_target_texture_destroy(gui, &menu->texture);
+
+  menu->has_drawing = false;
+
+  menu->width  = width;
+  menu->height = height;
+
+  gui_menu_damage(menu, (SDL_Rect) { 0, 0, width, height });
+
+  gui_grid_invalidate(&menu->grid);
+
+
+  for (size_t index = 0; index < menu->window_count; index++)
+  {
+    gui_window_t* window = menu->windows[index];
+
+    if (gui_window_resize(window, width, height) != 0)
+    {
+      return 4;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Resize gui screen to width and height
+ */
+int gui_resize(gui_t* gui, int width, int height)
+{
+  if (!gui)
+  {
+    return 1;
+  }
+
+  // The logical size only applies to the screen target
+  if (gui_target_set(gui, NULL) != 0)
+  {
+    return 2;
+  }
+
+  if (SDL_RenderSetLogicalSize(gui->renderer, width, height) != 0)
+  {
+    fprintf(stderr, "SDL_RenderSetLogicalSize: %s\n", SDL_GetError());
+
+    return 2;
+  }
+
+  gui->width  = width;
+  gui->height = height;
+
+  // Only the active menu is laid out now, the others when they are activated
+  gui_menu_t* menu = gui_menu_get(gui, gui->menu_name);
+
+  if (menu && gui_menu_resize(menu, width, height) != 0)
+  {
+    return 3;
+  }
+
+  return 0;
+}
+
+/*
+ * Set active menu
+ *
+ * A menu that was inactive when gui was resized is laid out, and its
+ * preload group is loaded, before the switch. The previous menu
+ * releases its texture, unless something is drawn on it
+ */
+int gui_active_menu_set(gui_t* gui, char* name)
+{
+  if (!gui)
+  {
+    return 1;
+  }
+
+  gui_menu_t* menu = gui_menu_get(gui, name);
+
+  if (menu)
+  {
+    if ((menu->width != gui->width || menu->height != gui->height) &&
+        gui_menu_resize(menu, gui->width, gui->height) != 0)
+    {
+      return 2;
+    }
+
+    gui_menu_preload_finish(gui, menu);
+  }
+
+  gui_menu_t* last_menu = gui_menu_get(gui, gui->menu_name);
+
+  if (last_menu && last_menu != menu && !last_menu->has_drawing)
+  {
+    gui_target_texture_destroy(gui, &last_menu->texture);
+  }
+
+  gui->menu_name = name;
+
+  gui->is_hover_cached = false;
+
+  // The next gui_render notices the switch, and presents the new menu
+  return 0;
+}
+
+/*
+ * Default event handler for resize event
+ */
+static inline void* _gui_event_resize_handle(gui_t* gui, int width, int height)
+{
+  gui_resize(gui, width, height);
+}
+
+/*
+ * Create default event and asign handlers
+ */
+static inline int _gui_events_create(gui_t* gui)
+{
+  if (gui_events_builtin_add(gui) != 0)
+  {
+    fprintf(stderr, "gui_events_builtin_add failed\n");
+
+    return 3;
+  }
+
+  if (gui_event_create(gui, "quit",
+    (gui_event_handler_t)
+    {
+      .type = GUI_EVENT_HANDLER_GUI,
+      .handler.gui = &_gui_event_quit_handle
+    }) != 0)
+  {
+    fprintf(stderr, "gui_event_create quit failed\n");
+
+    return 1;
+  }
+
+  if (gui_event_create(gui, "resize",
+    (gui_event_handler_t)
+    {
+      .type = GUI_EVENT_HANDLER_RESIZE,
+      .handler.resize = &_gui_event_resize_handle
+    }) != 0)
+  {
+    fprintf(stderr, "gui_event_create resize failed\n");
+
+    return 2;
+  }
+
+  return 0;
+}
+
+/*
+ * Create gui
+ */
+gui_t* gui_create(int width, int height, char* title)
+{
+  return gui_backend_create(width, height, title, GUI_BACKEND_WINDOW);
+}
+
+/*
+ * Create renderer of backend, and window or surface it renders to
+ */
+static inline int gui_backend_renderer_create(gui_t* gui, int width, int height, char* title)
+{
+  switch (gui->backend)
+  {
+    case GUI_BACKEND_WINDOW:
+      gui->window = sdl_window_create(width, height, title);
+
+      if (!gui->window)
+      {
+        return 1;
+      }
+
+      gui->renderer = sdl_renderer_create(gui->window);
+      break;
+
+    case GUI_BACKEND_SOFTWARE:
+      gui->surface = sdl_surface_create(width, height);
+
+      if (!gui->surface)
+      {
+        return 1;
+      }
+
+      gui->renderer = sdl_software_renderer_create(gui->surface);
+      break;
+
+    case GUI_BACKEND_NULL:
+      gui->surface = sdl_surface_create(1, 1);
+
+      if (!gui->surface)
+      {
+        return 1;
+      }
+
+      gui->renderer = sdl_software_renderer_create(gui->surface);
+      break;
+
+    default:
+      return 3;
+  }
+
+  if (!gui->renderer)
+  {
+    sdl_window_destroy(&gui->window);
+
+    sdl_surface_destroy(&gui->surface);
+
+    return 2;
+  }
+
+  return 0;
+}
+
+/*
+ * Create gui with backend
+ *
+ * The offscreen backends have no window, and are meant for
+ * benchmarking and testing on machines without a display
+ */
+gui_t* gui_backend_create(int width, int height, char* title, gui_backend_t backend)
+{
+  gui_t* gui = malloc(sizeof(gui_t));
+
+  if (!gui)
+  {
+    return NULL;
+  }
+
+  memset(gui, 0, sizeof(gui_t));
+
+  gui->backend = backend;
+
+  if (gui_backend_renderer_create(gui, width, height, title) != 0)
+  {
+    free(gui);
+
+    return NULL;
+  }
+
+  if (_gui_events_create(gui) != 0)
+  {
+    gui_events_destroy(&gui->events, gui->event_count);
+
+    free(gui->event_index.slots);
+
+    sdl_renderer_destroy(&gui->renderer);
+
+    sdl_window_destroy(&gui->window);
+
+    sdl_surface_destroy(&gui->surface);
+
+    free(gui);
+
+    return NULL;
+  }
+
+  gui->title  = title;
+  gui->width  = width;
+  gui->height = height;
+
+  gui->text_cache.budget = GUI_TEXT_CACHE_BUDGET;
+
+  gui->memory_budget = GUI_MEMORY_BUDGET;
+
+  gui->resize_delay_ms = GUI_RESIZE_DELAY_MS;
+
+  gui->assets = gui_assets_create();
+
+  return gui;
+}
+
+/*
+ * Only create menu (This is an internal function)
+ */
+static inline gui_menu_t* _gui_menu_create(gui_t* gui, char* name)
+{
+  gui_menu_t* menu = malloc(sizeof(gui_menu_t));
+
+  memset(menu, 0, sizeof(gui_menu_t));
+
+  menu->name = name;
+  menu->gui  = gui;
+
+  menu->preload_ticket = GUI_TICKET_NONE;
+
+  menu->width  = gui->width;
+  menu->height = gui->height;
+
+  // The menu texture is created when the menu is first rendered to
+
+  return menu;
+}
+
+/*
+ * Only destroy menu (This is an internal function)
+ */
+static inline void _gui_menu_destroy(gui_menu_t** menu)
+{
+  if (!menu || !(*menu)) return;
+
+  for (size_t index = 0; index < (*menu)->window_count; index++)
+  {
+    _gui_window_destroy(&(*menu)->windows[index]);
+  }
+
+  free((*menu)->windows);
+
+  gui_grid_free(&(*menu)->grid);
+
+  free((*menu)->preload_names);
+
+  gui_draw_list_free(&(*menu)->draw_list);
+
+  gui_target_texture_destroy((*menu)->gui, &(*menu)->texture);
+
+  free(*menu);
+
+  *menu = NULL;
+}
+
+/*
+ * Create menu and add it to GUI
+ */
+gui_menu_t* gui_menu_create(gui_t* gui, char* name)
+{
+  if (!gui || !name)
+  {
+    return NULL;
+  }
+
+  gui_menu_t* menu = _gui_menu_create(gui, name);
+
+  if (!menu)
+  {
+    return NULL;
+  }
+
+  gui_menu_t** temp_menus = realloc(gui->menus, sizeof(gui_menu_t*) * (gui->menu_count + 1));
+
+  if (!temp_menus)
+  {
+    _gui_menu_destroy(&menu);
+
+    return NULL;
+  }
+
+  gui->menus = temp_menus;
+
+  gui->menus[gui->menu_count++] = menu;
+
+  // Set the newly created menu as the active one
+  gui->menu_name = name;
+
+  gui->is_hover_cached = false;
+
+  return menu;
+}
+
+/*
+ * Get menu by name
+ */
+gui_menu_t* gui_menu_get(gui_t* gui, const char* name)
+{
+  if (!gui || !name)
+  {
+    return NULL;
+  }
+
+  for (size_t index = 0; index < gui->menu_count; index++)
+  {
+    gui_menu_t* menu = gui->menus[index];
+
+    if (menu && strcmp(menu->name, name) == 0)
+    {
+      return menu;
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * Get menu by name, to draw to it or to show it
+ *
+ * A menu that was inactive when gui was resized is laid out first,
+ * so that it isn't drawn to at the old size. NULL is returned
+ * if there is no such menu, or if it can't be laid out
+ */
+static inline gui_menu_t* gui_menu_layout_get(gui_t* gui, const char* name)
+{
+  gui_menu_t* menu = gui_menu_get(gui, name);
+
+  if (menu && (menu->width != gui->width || menu->height != gui->height) &&
+      gui_menu_resize(menu, gui->width, gui->height) != 0)
+  {
+    return NULL;
+  }
+
+  return menu;
+}
+
+/*
+ * Get active menu
+ */
+static inline gui_menu_t* gui_active_menu_get(gui_t* gui)
+{
+  if (!gui) return NULL;
+
+  return gui_menu_get(gui, gui->menu_name);
+}
+
+/*
+ * Get index of menu by name
+ */
+static inline ssize_t gui_menu_index_get(gui_t* gui, const char* name)
+{
+  if (!gui || !name)
+  {
+    return -1;
+  }
+
+  for (ssize_t index = 0; index < gui->menu_count; index++)
+  {
+    gui_menu_t* menu = gui->menus[index];
+
+    if (menu && strcmp(menu->name, name) == 0)
+    {
+      return index;
+    }
+  }
+
+  return -1;
+}
+
+/*
+ * Remove menu from GUI and destroy it
+ */
+int gui_menu_destroy(gui_t* gui, const char* name)
+{
+  if (!gui || !name)
+  {
+    return 1;
+  }
+
+  ssize_t menu_index = gui_menu_index_get(gui, name);
+
+  if (menu_index == -1)
+  {
+    return 2;
+  }
+
+  if (gui->render_menu == gui->menus[menu_index])
+  {
+    gui->render_menu = NULL;
+  }
+
+  _gui_menu_destroy(&gui->menus[menu_index]);
+
+
+  for (size_t index = menu_index; index < (gui->menu_count - 1); index++)
+  {
+    gui->menus[index] = gui->menus[index + 1];
+  }
+
+  gui->menu_count--;
+
+
+  gui_menu_t** temp_menus = realloc(gui->menus, sizeof(gui_menu_t*) * gui->menu_count);
+
+  if (!temp_menus)
+  {
+    // Here, the menu is destroyed, but the menus array isn't shrunk
+    return 3;
+  }
+
+  gui->menus = temp_menus;
+
+  return 0;
+}
+
+/*
+ * Try to get the window child which x and y is pointing at
+ */
+static inline gui_window_t* gui_window_x_and_y_child_get(gui_window_t* window, int x, int y)
+{
+  gui_window_t* child = gui_grid_x_and_y_window_get(&window->grid, window->children, window->child_count, window->sdl_rect.w, window->sdl_rect.h, x, y);
+
+  if (child)
+  {
+    int child_x = x - child->sdl_rect.x;
+    int child_y = y - child->sdl_rect.y;
+
+    gui_window_t* grandchild = gui_window_x_and_y_child_get(child, child_x, child_y);
+
+    return grandchild ? grandchild : child;
+  }
+
+  return NULL;
+}
+
+/*
+ * Try to get the window which x and y is pointing at
+ */
+gui_window_t* gui_x_and_y_window_get(gui_t* gui, int x, int y)
+{
+  gui_menu_t* menu = gui_active_menu_get(gui);
+
+  if (!menu)
+  {
+    return NULL;
+  }
+
+  gui_window_t* window = gui_grid_x_and_y_window_get(&menu->grid, menu->windows, menu->window_count, gui->width, gui->height, x, y);
+
+  if (window)
+  {
+    int window_x = x - window->sdl_rect.x;
+    int window_y = y - window->sdl_rect.y;
+
+    gui_window_t* child = gui_window_x_and_y_child_get(window, window_x, window_y);
+
+    return child ? child : window;
+  }
+
+  return NULL;
+}
+
+/*
+ *
+ */
+static inline void gui_event_handler_call(gui_t* gui, SDL_Event* event, gui_window_t* window, gui_event_handler_t handler)
+{
+  int x = event->button.x;
+  int y = event->button.y;
+
+  int key = event->key.keysym.sym;
+
+  int width  = event->window.data1;
+  int height = event->window.data2;
+
+  switch (handler.type)
+  {
+    case GUI_EVENT_HANDLER_GUI:
+      if (handler.handler.gui)
+      {
+        handler.handler.gui(gui);
+      }
+      break;
+
+    case GUI_EVENT_HANDLER_KEY:
+      if (handler.handler.key)
+      {
+        handler.handler.key(gui, key);
+      }
+      break;
+
+    case GUI_EVENT_HANDLER_MOUSE:
+      if (handler.handler.mouse)
+      {
+        handler.handler.mouse(gui, x, y);
+      }
+      break;
+
+    case GUI_EVENT_HANDLER_RESIZE:
+      if (handler.handler.resize)
+      {
+        handler.handler.resize(gui, width, height);
+      }
+      break;
+
+    case GUI_EVENT_HANDLER_WINDOW:
+      if (handler.handler.window)
+      {
+        handler.handler.window(gui, window);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+/*
+ * Trigger event by calling handlers of type GUI_EVENT_HANDLER_GUI,
+ * which does not require any input data
+ */
+void gui_user_event_id_trigger(gui_t* gui, int id)
+{
+  if (!gui) return;
+
+  gui_event_t* gui_event = gui_event_get(gui, id);
+
+  if (!gui_event) return;
+
+  GUI_PROFILE_BEGIN(start_us);
+
+  for (size_t index = 0; index < gui_event->handler_count; index++)
+  {
+    gui_event_handler_t handler = gui_event->handlers[index];
+
+    if (handler.type == GUI_EVENT_HANDLER_GUI)
+    {
+      if (handler.handler.gui)
+      {
+        handler.handler.gui(gui);
+      }
+    }
+  }
+
+  GUI_PROFILE_END(gui, start_us, gui_event->name, "handler");
+}
+
+/*
+ * Trigger event by name, see gui_user_event_id_trigger
+ */
+void gui_user_event_trigger(gui_t* gui, char* name)
+{
+  gui_user_event_id_trigger(gui, gui_event_id_get(gui, name));
+}
+
+/*
+ *
+ */
+static inline void gui_event_handlers_call(gui_t* gui, SDL_Event* event, gui_window_t* window, gui_event_t* gui_event)
+{
+  GUI_PROFILE_BEGIN(start_us);
+
+  for (size_t index = 0; index < gui_event->handler_count; index++)
+  {
+    gui_event_handler_t handler = gui_event->handlers[index];
+
+    gui_event_handler_call(gui, event, window, handler);
+  }
+
+  GUI_PROFILE_END(gui, start_us, gui_event->name, "handler");
+}
+
+/*
+ *
+ */
+static inline void gui_event_trigger(gui_t* gui, SDL_Event* event, gui_window_t* window, gui_event_id_t id)
+{
+  gui_event_t* gui_event = gui_event_get(gui, id);
+
+  if (!gui_event) return;
+
+  gui_event_handlers_call(gui, event, window, gui_event);
+}
+
+/*
+ *
+ */
+static inline void gui_mouse_up_event_handle(gui_t* gui, SDL_Event* event)
+{
+  int x = event->button.x;
+  int y = event->button.y;
+
+  gui_window_t* window = gui_x_and_y_window_get(gui, x, y);
+
+  switch (event->button.button)
+  {
+    case SDL_BUTTON_LEFT:
+      gui_event_trigger(gui, event, window, GUI_EVENT_MOUSE_UP_LEFT);
+      break;
+
+    case SDL_BUTTON_RIGHT:
+      gui_event_trigger(gui, event, window, GUI_EVENT_MOUSE_UP_RIGHT);
+      break;
+
+    default:
+      break;
+  }
+}
+
+/*
+ *
+ */
+static inline void gui_mouse_down_event_handle(gui_t* gui, SDL_Event* event)
+{
+  int x = event->button.x;
+  int y = event->button.y;
+
+  gui_window_t* window = gui_x_and_y_window_get(gui, x, y);
+
+  switch (event->button.button)
+  {
+    case SDL_BUTTON_LEFT:
+      gui_event_trigger(gui, event, window, GUI_EVENT_MOUSE_DOWN_LEFT);
+      break;
+
+    case SDL_BUTTON_RIGHT:
+      gui_event_trigger(gui, event, window, GUI_EVENT_MOUSE_DOWN_RIGHT);
+      break;
+
+    default:
+      break;
+  }
+}
+
+/*
+ * Set the time the window size has to be stable, before gui is resized
+ *
+ * Until then, the last frame is shown scaled to the window
+ */
+int gui_resize_delay_set(gui_t* gui, int delay_ms)
+{
+  if (!gui || delay_ms < 0)
+  {
+    return 1;
+  }
+
+  gui->resize_delay_ms = delay_ms;
+
+  return 0;
+}
+
+/*
+ * Remember the new window size, without resizing gui
+ *
+ * Both RESIZED and SIZE_CHANGED arrive for one resize,
+ * and a drag sends many sizes, so only the latest is kept
+ */
+static inline void gui_resize_defer(gui_t* gui, SDL_Event* event)
+{
+  int width  = event->window.data1;
+  int height = event->window.data2;
+
+  if (gui->is_resize_pending)
+  {
+    if (width == gui->resize_width && height == gui->resize_height)
+    {
+      return;
+    }
+
+    gui->stats.resize_coalesced_count++;
+  }
+  else if (width == gui->width && height == gui->height)
+  {
+    return;
+  }
+
+  gui->is_resize_pending = true;
+  gui->resize_width      = width;
+  gui->resize_height     = height;
+  gui->resize_ticks      = SDL_GetTicks();
+
+  // The logical size is kept, so SDL scales the last frame to the window
+  gui->render_menu = NULL;
+}
+
+/*
+ * Get milliseconds until the pending resize is due, or -1 if there is none
+ */
+static inline int gui_resize_timeout_get(gui_t* gui)
+{
+  if (!gui->is_resize_pending)
+  {
+    return -1;
+  }
+
+  Uint32 elapsed_ticks = SDL_GetTicks() - gui->resize_ticks;
+
+  return (elapsed_ticks >= (Uint32) gui->resize_delay_ms) ? 0 : (gui->resize_delay_ms - elapsed_ticks);
+}
+
+/*
+ * Trigger the resize event, once the window size has been stable long enough
+ */
+static inline void gui_resize_flush(gui_t* gui)
+{
+  if (gui_resize_timeout_get(gui) != 0)
+  {
+    return;
+  }
+
+  gui->is_resize_pending = false;
+
+  if (gui->resize_width == gui->width && gui->resize_height == gui->height)
+  {
+    return;
+  }
+
+  SDL_Event event;
+  SDL_memset(&event, 0, sizeof(event));
+
+  event.window.type  = SDL_WINDOWEVENT;
+  event.window.event = SDL_WINDOWEVENT_RESIZED;
+  event.window.data1 = gui->resize_width;
+  event.window.data2 = gui->resize_height;
+
+  gui_event_trigger(gui, &event, NULL, GUI_EVENT_RESIZE);
+}
+
+/*
+ * Handle window event
+ */
+static inline void gui_window_event_handle(gui_t* gui, SDL_Event* event)
+{
+  switch (event->window.event)
+  {
+    case SDL_WINDOWEVENT_RESIZED: case SDL_WINDOWEVENT_SIZE_CHANGED:
+      gui_resize_defer(gui, event);
+      break;
+
+    case SDL_WINDOWEVENT_EXPOSED:
+      // The screen has to be presented again, but nothing has changed
+      gui->render_menu = NULL;
+      break;
+
+    default:
+      break;
+  }
+}
+
+/*
+ * Get the area in screen coordinates where window is hit by a hit test
+ *
+ * False is returned if the area isn't a plain rect, because the window
+ * has children, or because windows above it overlap it
+ */
+static inline bool gui_window_hover_rect_get(gui_window_t* window, SDL_Rect* hover_rect)
+{
+  if (window->child_count > 0)
+  {
+    return false;
+  }
+
+  // Hit testing includes the right and bottom edges
+  SDL_Rect rect = { window->sdl_rect.x, window->sdl_rect.y, window->sdl_rect.w + 1, window->sdl_rect.h + 1 };
+
+  gui_window_t* curr = window;
+
+  while (curr)
+  {
+    gui_window_t** siblings;
+    size_t         count;
+
+    gui_window_t* parent = curr->is_child ? curr->parent.window : NULL;
+
+    if (parent)
+    {
+      siblings = parent->children;
+      count    = parent->child_count;
+    }
+    else if (!curr->is_child && curr->parent.menu)
+    {
+      siblings = curr->parent.menu->windows;
+      count    = curr->parent.menu->window_count;
+    }
+    else return false;
+
+    // The windows after curr are above it
+    bool is_above = false;
+
+    for (size_t index = 0; index < count; index++)
+    {
+      gui_window_t* sibling = siblings[index];
+
+      SDL_Rect sibling_rect = { sibling->sdl_rect.x, sibling->sdl_rect.y, sibling->sdl_rect.w + 1, sibling->sdl_rect.h + 1 };
+
+      if (is_above && SDL_HasIntersection(&rect, &sibling_rect))
+      {
+        return false;
+      }
+
+      if (sibling == curr) is_above = true;
+    }
+
+    if (!parent) break;
+
+    // A child is only hit inside of its parent
+    SDL_Rect bounds = { 0, 0, parent->sdl_rect.w + 1, parent->sdl_rect.h + 1 };
+
+    if (!SDL_IntersectRect(&rect, &bounds, &rect))
+    {
+      return false;
+    }
+
+    rect.x += parent->sdl_rect.x;
+    rect.y += parent->sdl_rect.y;
+
+    curr = parent;
+  }
+
+  *hover_rect = rect;
+
+  return true;
+}
+
+/*
+ * Set if the mouse motions of one poll batch are merged into one
+ */
+int gui_motion_coalesce_set(gui_t* gui, bool is_coalesced)
+{
+  if (!gui)
+  {
+    return 1;
+  }
+
+  gui->is_motion_coalesced = is_coalesced;
+
+  return 0;
+}
+
+/*
+ *
+ */
+static inline void gui_mouse_motion_event_handle(gui_t* gui, SDL_Event* event)
+{
+  int x = event->button.x;
+  int y = event->button.y;
+
+  gui_window_t* window = NULL;
+
+  SDL_Point point = { x, y };
+
+  // Inside the hovered window, the hit test would give the same window
+  if (gui->is_hover_cached && SDL_PointInRect(&point, &gui->hover_rect))
+  {
+    window = gui->curr_window;
+
+    gui->stats.hit_test_skipped_count++;
+  }
+  else
+  {
+    window = gui_x_and_y_window_get(gui, x, y);
+  }
+
+  gui_event_trigger(gui, event, window, GUI_EVENT_MOUSE_MOTION);
+
+
+  if (window != gui->curr_window)
+  {
+    gui->is_hover_cached = false;
+
+    if (gui->curr_window)
+    {
+      gui->last_window = gui->curr_window;
+
+      gui->curr_window = NULL;
+
+      gui_event_trigger(gui, event, gui->last_window, GUI_EVENT_WINDOW_EXIT);
+    }
+
+    if (window)
+    {
+      gui->last_window = gui->curr_window;
+
+      gui->curr_window = window;
+
+      gui_event_trigger(gui, event, gui->curr_window, GUI_EVENT_WINDOW_ENTER);
+    }
+  }
+
+  if (!gui->is_hover_cached && gui->curr_window)
+  {
+    gui->is_hover_cached = gui_window_hover_rect_get(gui->curr_window, &gui->hover_rect);
+  }
+}
+
+/*
+ * Keep the latest mouse motion, to handle it once after the poll batch
+ */
+static inline void gui_motion_coalesce(gui_t* gui, SDL_Event* event)
+{
+  if (gui->is_motion_pending)
+  {
+    event->motion.xrel += gui->motion_event.motion.xrel;
+    event->motion.yrel += gui->motion_event.motion.yrel;
+
+    gui->stats.motion_coalesced_count++;
+  }
+
+  gui->motion_event = *event;
+
+  gui->is_motion_pending = true;
+}
+
+/*
+ * Handle the pending coalesced mouse motion
+ */
+static inline void gui_motion_flush(gui_t* gui)
+{
+  if (!gui->is_motion_pending) return;
+
+  gui->is_motion_pending = false;
+
+  gui_mouse_motion_event_handle(gui, &gui->motion_event);
+}
+
+/*
+ * Handle event
+ */
+static inline void gui_event_handle(gui_t* gui, SDL_Event* event)
+{
+  if (!event) return;
+
+  GUI_PROFILE_BEGIN(start_us);
+
+  // Other events should see the pointer where it was when they happened
+  if (gui->is_motion_pending && event->type != SDL_MOUSEMOTION)
+  {
+    gui_motion_flush(gui);
+  }
+
+  switch (event->type)
+  {
+    case SDL_QUIT:
+      gui_event_trigger(gui, event, NULL, GUI_EVENT_QUIT);
+      break;
+
+    case SDL_WINDOWEVENT:
+      gui_window_event_handle(gui, event);
+      break;
+
+    case SDL_MOUSEBUTTONDOWN:
+      gui_mouse_down_event_handle(gui, event);
+      break;
+
+    case SDL_MOUSEBUTTONUP:
+      gui_mouse_up_event_handle(gui, event);
+      break;
+
+    case SDL_KEYDOWN:
+      gui_event_trigger(gui, event, NULL, GUI_EVENT_KEY_DOWN);
+      break;
+
+    case SDL_KEYUP:
+      gui_event_trigger(gui, event, NULL, GUI_EVENT_KEY_UP);
+      break;
+
+    case SDL_MOUSEMOTION:
+      if (gui->is_motion_coalesced)
+      {
+        gui_motion_coalesce(gui, event);
+      }
+      else
+      {
+        gui_mouse_motion_event_handle(gui, event);
+      }
+      break;
 
-  if (sdl_target_texture_render(renderer, menu->texture, gui_texture->texture, &sdl_rect) != 0)
-  {
-    return 5;
+    default:
+      break;
   }
 
-  return 0;
+  GUI_PROFILE_END(gui, start_us, "event", "event");
 }
 
 /*
- * Default event handler for quit event
+ * Bundle
  */
-static inline void* _gui_event_quit_handle(gui_t* gui)
+
+#define GUI_BUNDLE_MAGIC   "GUIB"
+#define GUI_BUNDLE_VERSION 1
+
+/*
+ * Header at the start of a bundle file, followed by the entries
+ */
+typedef struct gui_bundle_header_t
 {
-  gui->is_running = false;
-}
+  char     magic[4];
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t reserved;
+} gui_bundle_header_t;
 
 /*
- * Resize window texture and children
+ * Entry of packed asset in a bundle file
+ *
+ * Textures are stored as decoded pixels, fonts as their file data,
+ * and chunks as PCM in the audio format of the mixer
  */
-static inline int gui_window_resize(gui_window_t* window, int width, int height)
+typedef struct gui_bundle_entry_t
 {
-  if (!window)
-  {
-    return 1;
-  }
+  char     name[48]; // Null terminated
+  uint32_t kind;     // gui_asset_kind_t
+  uint32_t width;    // Texture width, or chunk frequency
+  uint32_t height;   // Texture height, or chunk channels
+  uint32_t format;   // SDL pixel format, or SDL audio format
+  uint64_t offset;   // Offset of data from start of file
+  uint64_t size;
+} gui_bundle_entry_t;
 
-  gui_t* gui = window->gui;
+/*
+ * Map bundle file into memory
+ *
+ * Where mmap is not available, the file is read into memory instead
+ */
+static inline void* gui_bundle_map(const char* filepath, size_t* size)
+{
+#ifndef _WIN32
+  int fd = open(filepath, O_RDONLY);
 
-  if (!gui)
+  if (fd == -1)
   {
-    return 2;
-  }
-
-  SDL_Renderer* renderer = gui->renderer;
-
-  window->sdl_rect = sdl_rect_create(window->gui_rect, width, height);
+    fprintf(stderr, "open: %s: %s\n", filepath, strerror(errno));
 
-  if (sdl_texture_resize(&window->texture, renderer, window->sdl_rect.w, window->sdl_rect.h) != 0)
-  {
-    return 3;
+    return NULL;
   }
 
+  struct stat stat_buffer;
 
-  for (size_t index = 0; index < window->child_count; index++)
+  if (fstat(fd, &stat_buffer) == -1 || stat_buffer.st_size < (off_t) sizeof(gui_bundle_header_t))
   {
-    gui_window_t* child = window->children[index];
+    fprintf(stderr, "Bad bundle file: %s\n", filepath);
 
-    if (gui_window_resize(child, window->sdl_rect.w, window->sdl_rect.h) != 0)
-    {
-      return 4;
-    }
+    close(fd);
+
+    return NULL;
   }
 
-  return 0;
-}
+  void* data = mmap(NULL, stat_buffer.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
 
-/*
- * Resize menu texture and windows within it
- */
-static inline int gui_menu_resize(gui_menu_t* menu, int width, int height)
-{
-  if (!menu)
+  // The mapping stays valid after the file is closed
+  close(fd);
+
+  if (data == MAP_FAILED)
   {
-    return 1;
+    fprintf(stderr, "mmap: %s: %s\n", filepath, strerror(errno));
+
+    return NULL;
   }
 
-  gui_t* gui = menu->gui;
+  *size = stat_buffer.st_size;
 
-  if (!gui)
-  {
-    return 2;
-  }
+  return data;
+#else // _WIN32
+  size_t data_size = 0;
 
-  SDL_Renderer* renderer = gui->renderer;
+  void* data = SDL_LoadFile(filepath, &data_size);
 
-  if (sdl_texture_resize(&menu->texture, renderer, width, height) != 0)
+  if (!data)
   {
-    return 3;
-  }
+    fprintf(stderr, "SDL_LoadFile: %s\n", SDL_GetError());
 
+    return NULL;
+  }
 
-  for (size_t index = 0; index < menu->window_count; index++)
+  if (data_size < sizeof(gui_bundle_header_t))
   {
-    gui_window_t* window = menu->windows[index];
+    fprintf(stderr, "Bad bundle file: %s\n", filepath);
 
-    if (gui_window_resize(window, width, height) != 0)
-    {
-      return 4;
-    }
+    SDL_free(data);
+
+    return NULL;
   }
 
-  return 0;
+  *size = data_size;
+
+  return data;
+#endif // _WIN32
 }
 
 /*
- * Resize gui screen to width and height
+ * Create texture from pixels in bundle
  */
-int gui_resize(gui_t* gui, int width, int height)
+static inline int gui_bundle_texture_add(gui_t* gui, gui_bundle_entry_t* entry, void* data)
 {
-  if (!gui)
+  SDL_Texture* texture = SDL_CreateTexture(gui->renderer, entry->format, SDL_TEXTUREACCESS_STATIC, entry->width, entry->height);
+
+  if (!texture)
   {
+    fprintf(stderr, "SDL_CreateTexture: %s\n", SDL_GetError());
+
     return 1;
   }
 
-  if (SDL_RenderSetLogicalSize(gui->renderer, width, height) != 0)
+  if (SDL_UpdateTexture(texture, NULL, data, entry->width * SDL_BYTESPERPIXEL(entry->format)) != 0 ||
+      SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND) != 0)
   {
-    fprintf(stderr, "SDL_RenderSetLogicalSize: %s\n", SDL_GetError());
+    fprintf(stderr, "SDL_UpdateTexture: %s\n", SDL_GetError());
+
+    sdl_texture_destroy(&texture);
 
     return 2;
   }
 
-  gui->width  = width;
-  gui->height = height;
+  gui_texture_t* gui_texture = gui_texture_create(entry->name, texture);
 
-  for (size_t index = 0; index < gui->menu_count; index++)
+  if (!gui_texture)
   {
-    gui_menu_t* menu = gui->menus[index];
+    sdl_texture_destroy(&texture);
 
-    if (gui_menu_resize(menu, gui->width, gui->height) != 0)
-    {
-      return 3;
-    }
+    return 3;
+  }
+
+  if (gui_assets_texture_add(gui->assets, gui_texture) != 0)
+  {
+    gui_texture_destroy(&gui_texture);
+
+    return 4;
   }
 
   return 0;
 }
 
 /*
- * Default event handler for resize event
+ * Open font from file data in bundle, which FreeType reads in place
  */
-static inline void* _gui_event_resize_handle(gui_t* gui, int width, int height)
+static inline int gui_bundle_font_add(gui_t* gui, gui_bundle_entry_t* entry, void* data)
 {
-  gui_resize(gui, width, height);
-}
+  SDL_RWops* rw = SDL_RWFromConstMem(data, entry->size);
 
-/*
- * Create default event and asign handlers
- */
-static inline int _gui_events_create(gui_t* gui)
-{
-  if (gui_event_create(gui, "quit",
-    (gui_event_handler_t)
-    {
-      .type = GUI_EVENT_HANDLER_GUI,
-      .handler.gui = &_gui_event_quit_handle
-    }) != 0)
+  TTF_Font* font = rw ? TTF_OpenFontRW(rw, 1, 24) : NULL;
+
+  if (!font)
   {
-    fprintf(stderr, "gui_event_create quit failed\n");
+    fprintf(stderr, "TTF_OpenFontRW: %s\n", TTF_GetError());
 
     return 1;
   }
 
-  if (gui_event_create(gui, "resize",
-    (gui_event_handler_t)
-    {
-      .type = GUI_EVENT_HANDLER_RESIZE,
-      .handler.resize = &_gui_event_resize_handle
-    }) != 0)
+  gui_font_t* gui_font = gui_font_create(entry->name, font);
+
+  if (!gui_font)
   {
-    fprintf(stderr, "gui_event_create resize failed\n");
+    ttf_font_destroy(&font);
 
     return 2;
   }
 
+  if (gui_assets_font_add(gui->assets, gui_font) != 0)
+  {
+    gui_font_destroy(&gui_font);
+
+    return 3;
+  }
+
   return 0;
 }
 
 /*
- * Create gui
+ * Create chunk that plays PCM in bundle, without copying it
  */
-gui_t* gui_create(int width, int height, char* title)
+static inline int gui_bundle_chunk_add(gui_t* gui, gui_bundle_entry_t* entry, void* data)
 {
-  gui_t* gui = malloc(sizeof(gui_t));
+  int    frequency;
+  Uint16 format;
+  int    channels;
 
-  if (!gui)
+  if (Mix_QuerySpec(&frequency, &format, &channels) == 0 ||
+      (uint32_t) frequency != entry->width || (uint32_t) channels != entry->height || format != entry->format)
   {
-    return NULL;
-  }
+    fprintf(stderr, "Bundled chunk doesn't match audio format: %s\n", entry->name);
 
-  memset(gui, 0, sizeof(gui_t));
+    return 1;
+  }
 
-  gui->window = sdl_window_create(width, height, title);
+  Mix_Chunk* chunk = Mix_QuickLoad_RAW(data, entry->size);
 
-  if (!gui->window)
+  if (!chunk)
   {
-    free(gui);
+    fprintf(stderr, "Mix_QuickLoad_RAW: %s\n", Mix_GetError());
 
-    return NULL;
+    return 2;
   }
 
-  gui->renderer = sdl_renderer_create(gui->window);
+  gui_chunk_t* gui_chunk = gui_chunk_create(entry->name, chunk);
 
-  if (!gui->renderer)
+  if (!gui_chunk)
   {
-    sdl_window_destroy(&gui->window);
-
-    free(gui);
+    mix_chunk_destroy(&chunk);
 
-    return NULL;
+    return 3;
   }
 
-  if (_gui_events_create(gui) != 0)
+  if (gui_assets_chunk_add(gui->assets, gui_chunk) != 0)
   {
-    sdl_window_destroy(&gui->window);
-
-    free(gui);
+    gui_chunk_destroy(&gui_chunk);
 
-    return NULL;
+    return 4;
   }
 
-  gui->title  = title;
-  gui->width  = width;
-  gui->height = height;
-
-  gui->assets = gui_assets_create();
-
-  return gui;
+  return 0;
 }
 
 /*
- * Only create menu (This is an internal function)
+ * Check that bundle header and entries are inside of the mapped file
  */
-static inline gui_menu_t* _gui_menu_create(gui_t* gui, char* name)
+static inline bool gui_bundle_is_valid(void* data, size_t size)
 {
-  gui_menu_t* menu = malloc(sizeof(gui_menu_t));
+  gui_bundle_header_t* header = data;
 
-  memset(menu, 0, sizeof(gui_menu_t));
+  if (memcmp(header->magic, GUI_BUNDLE_MAGIC, 4) != 0 || header->version != GUI_BUNDLE_VERSION)
+  {
+    return false;
+  }
 
-  menu->name = name;
-  menu->gui  = gui;
+  if (header->entry_count > (size - sizeof(gui_bundle_header_t)) / sizeof(gui_bundle_entry_t))
+  {
+    return false;
+  }
 
-  menu->texture = sdl_texture_create(gui->renderer, gui->width, gui->height);
+  gui_bundle_entry_t* entries = (gui_bundle_entry_t*) (header + 1);
 
-  if (!menu->texture)
+  for (size_t index = 0; index < header->entry_count; index++)
   {
-    free(menu);
+    gui_bundle_entry_t* entry = &entries[index];
 
-    return NULL;
+    if (!memchr(entry->name, '\0', sizeof(entry->name)))
+    {
+      return false;
+    }
+
+    if (entry->offset > size || entry->size > size - entry->offset)
+    {
+      return false;
+    }
+
+    // The pixels of textures are read as rows of 4 byte pixels
+    if (entry->kind == GUI_ASSET_TEXTURE &&
+        (SDL_ISPIXELFORMAT_FOURCC(entry->format) || SDL_BYTESPERPIXEL(entry->format) != 4 ||
+         (uint64_t) entry->width * entry->height * 4 > entry->size))
+    {
+      return false;
+    }
   }
 
-  return menu;
+  return true;
 }
 
 /*
- * Only destroy menu (This is an internal function)
+ * Load packed assets from bundle file, which is made by the packer tool
+ *
+ * The file is mapped into memory, and the assets are created
+ * straight from the mapped data, without decoding any files
+ *
+ * Status 5 means that the bundle was loaded, but some of its entries
+ * failed. The other entries are still registered, so the caller
+ * should not load the assets again from files
  */
-static inline void _gui_menu_destroy(gui_menu_t** menu)
+int gui_bundle_load(gui_t* gui, const char* filepath)
 {
-  if (!menu || !(*menu)) return;
-
-  for (size_t index = 0; index < (*menu)->window_count; index++)
+  if (!gui || !filepath)
   {
-    _gui_window_destroy(&(*menu)->windows[index]);
+    return 1;
   }
 
-  free((*menu)->windows);
-
-  sdl_texture_destroy(&(*menu)->texture);
-
-  free(*menu);
+  gui_assets_t* assets = gui->assets;
 
-  *menu = NULL;
-}
+  gui_bundle_t* temp_bundles = realloc(assets->bundles, sizeof(gui_bundle_t) * (assets->bundle_count + 1));
 
-/*
- * Create menu and add it to GUI
- */
-gui_menu_t* gui_menu_create(gui_t* gui, char* name)
-{
-  if (!gui || !name)
+  if (!temp_bundles)
   {
-    return NULL;
+    return 2;
   }
 
-  gui_menu_t* menu = _gui_menu_create(gui, name);
+  assets->bundles = temp_bundles;
 
-  if (!menu)
+  size_t size = 0;
+
+  void* data = gui_bundle_map(filepath, &size);
+
+  if (!data)
   {
-    return NULL;
+    return 3;
   }
 
-  gui_menu_t** temp_menus = realloc(gui->menus, sizeof(gui_menu_t*) * (gui->menu_count + 1));
-
-  if (!temp_menus)
+  if (!gui_bundle_is_valid(data, size))
   {
-    _gui_menu_destroy(&menu);
+    fprintf(stderr, "Bad bundle file: %s\n", filepath);
 
-    return NULL;
+    gui_bundle_unmap(data, size);
+
+    return 4;
   }
 
-  gui->menus = temp_menus;
+  // The assets point into the bundle, so it is kept mapped
+  assets->bundles[assets->bundle_count++] = (gui_bundle_t) { data, size };
 
-  gui->menus[gui->menu_count++] = menu;
+  gui_bundle_header_t* header = data;
 
-  // Set the newly created menu as the active one
-  gui->menu_name = name;
+  gui_bundle_entry_t* entries = (gui_bundle_entry_t*) (header + 1);
 
-  return menu;
-}
+  int status = 0;
 
-/*
- * Get menu by name
- */
-static inline gui_menu_t* gui_menu_get(gui_t* gui, const char* name)
-{
-  if (!gui || !name)
+  for (size_t index = 0; index < header->entry_count; index++)
   {
-    return NULL;
-  }
+    gui_bundle_entry_t* entry = &entries[index];
 
-  for (size_t index = 0; index < gui->menu_count; index++)
-  {
-    gui_menu_t* menu = gui->menus[index];
+    void* entry_data = (char*) data + entry->offset;
+
+    int entry_status = 0;
+
+    switch (entry->kind)
+    {
+      case GUI_ASSET_TEXTURE:
+        entry_status = gui_bundle_texture_add(gui, entry, entry_data);
+        break;
+
+      case GUI_ASSET_FONT:
+        entry_status = gui_bundle_font_add(gui, entry, entry_data);
+        break;
+
+      case GUI_ASSET_CHUNK:
+        entry_status = gui_bundle_chunk_add(gui, entry, entry_data);
+        break;
+
+      default:
+        entry_status = 1;
+        break;
+    }
 
-    if (menu && strcmp(menu->name, name) == 0)
+    if (entry_status != 0)
     {
-      return menu;
+      fprintf(stderr, "Failed to load bundled asset: %.*s\n", (int) sizeof(entry->name), entry->name);
+
+      status = 5;
     }
   }
 
-  return NULL;
+  return status;
 }
 
 /*
- * Get active menu
+ * Asynchronous loading
  */
-static inline gui_menu_t* gui_active_menu_get(gui_t* gui)
-{
-  if (!gui) return NULL;
-
-  return gui_menu_get(gui, gui->menu_name);
-}
 
 /*
- * Get index of menu by name
+ * Set time per frame spent on uploading asynchronously loaded assets
  */
-static inline ssize_t gui_menu_index_get(gui_t* gui, const char* name)
+int gui_load_budget_set(gui_t* gui, int budget_us)
 {
-  if (!gui || !name)
+  if (!gui || budget_us <= 0)
   {
-    return -1;
+    return 1;
   }
 
-  for (ssize_t index = 0; index < gui->menu_count; index++)
-  {
-    gui_menu_t* menu = gui->menus[index];
+  gui->load_budget_us = budget_us;
 
-    if (menu && strcmp(menu->name, name) == 0)
+  return 0;
+}
+
+/*
+ * Get index of asynchronous load with ticket, -1 if it is done
+ */
+static inline ssize_t gui_load_index_get(gui_t* gui, gui_ticket_t ticket)
+{
+  for (size_t index = 0; index < gui->load_count; index++)
+  {
+    if (gui->loads[index]->ticket == ticket)
     {
       return index;
     }
@@ -2612,486 +8820,384 @@ static inline ssize_t gui_menu_index_get(gui_t* gui, const char* name)
 }
 
 /*
- * Remove menu from GUI and destroy it
+ * Start asynchronous load of assets, and get its ticket
  */
-int gui_menu_destroy(gui_t* gui, const char* name)
+static inline gui_ticket_t gui_assets_kind_load_async(gui_t* gui, gui_asset_kind_t kind, gui_asset_t* assets, size_t count)
 {
-  if (!gui || !name)
-  {
-    return 1;
-  }
-
-  ssize_t menu_index = gui_menu_index_get(gui, name);
+  gui_load_t** temp_loads = realloc(gui->loads, sizeof(gui_load_t*) * (gui->load_count + 1));
 
-  if (menu_index == -1)
+  if (!temp_loads)
   {
-    return 2;
+    return GUI_TICKET_NONE;
   }
 
-  _gui_menu_destroy(&gui->menus[menu_index]);
+  gui->loads = temp_loads;
 
+  gui_load_t* load = gui_load_create(gui, kind, assets, count);
 
-  for (size_t index = menu_index; index < (gui->menu_count - 1); index++)
+  if (!load)
   {
-    gui->menus[index] = gui->menus[index + 1];
+    return GUI_TICKET_NONE;
   }
 
+  load->ticket = gui->next_ticket++;
 
-  gui_menu_t** temp_menus = realloc(gui->menus, sizeof(gui_menu_t*) * (gui->menu_count - 1));
-
-  if (!temp_menus)
-  {
-    // Here, the menu is destroyed, but the menus array isn't shrunk
-    return 3;
-  }
-
-  gui->menus = temp_menus;
+  gui->loads[gui->load_count++] = load;
 
-  return 0;
+  return load->ticket;
 }
 
 /*
- * Events
- */
-
-/*
+ * Start loading textures, which are added to gui assets over the next frames
  *
+ * The progress is reported by the load-progress and load-done events
  */
-static inline gui_event_t* gui_event_get(gui_t* gui, char* name)
+gui_ticket_t gui_textures_load_async(gui_t* gui, gui_asset_t* assets, size_t count)
 {
-  for (size_t index = 0; index < gui->event_count; index++)
+  if (!gui || !assets)
   {
-    gui_event_t* event = gui->events[index];
-
-    if (strcmp(event->name, name) == 0)
-    {
-      return event;
-    }
+    return GUI_TICKET_NONE;
   }
 
-  return NULL;
+  return gui_assets_kind_load_async(gui, GUI_ASSET_TEXTURE, assets, count);
 }
 
 /*
- * Destroy gui event and remove handlers
+ * Start loading fonts, see gui_textures_load_async
  */
-static inline void gui_event_destroy(gui_event_t** event)
+gui_ticket_t gui_fonts_load_async(gui_t* gui, gui_asset_t* assets, size_t count)
 {
-  if (!event || !(*event)) return;
-
-  free((*event)->handlers);
-
-  free(*event);
+  if (!gui || !assets)
+  {
+    return GUI_TICKET_NONE;
+  }
 
-  *event = NULL;
+  return gui_assets_kind_load_async(gui, GUI_ASSET_FONT, assets, count);
 }
 
 /*
- * Destroy all gui events
+ * Start loading chunks, see gui_textures_load_async
  */
-void gui_events_destroy(gui_event_t*** events, size_t count)
+gui_ticket_t gui_chunks_load_async(gui_t* gui, gui_asset_t* assets, size_t count)
 {
-  for (size_t index = 0; index < count; index++)
+  if (!gui || !assets)
   {
-    gui_event_destroy(&(*events)[index]);
+    return GUI_TICKET_NONE;
   }
 
-  free(*events);
-
-  *events = NULL;
+  return gui_assets_kind_load_async(gui, GUI_ASSET_CHUNK, assets, count);
 }
 
 /*
- *
+ * Remove finished asynchronous load, and trigger the load-done event
  */
-static inline gui_event_t* _gui_event_create(char* name, gui_event_handler_t handler)
+static inline void gui_load_finish(gui_t* gui, size_t load_index)
 {
-  gui_event_t* event = malloc(sizeof(gui_event_t));
+  gui_load_t* load = gui->loads[load_index];
 
-  if (!event)
+  for (size_t index = load_index; index < (gui->load_count - 1); index++)
   {
-    return NULL;
+    gui->loads[index] = gui->loads[index + 1];
   }
 
-  event->name = name;
-
-  event->handlers = malloc(sizeof(gui_event_handler_t));
-
-  if (!event->handlers)
-  {
-    free(event);
-
-    return NULL;
-  }
+  gui->load_count--;
 
-  event->handlers[0] = handler;
-  event->handler_count = 1;
+  gui_load_event_trigger(gui, GUI_EVENT_LOAD_DONE, load);
 
-  return event;
+  gui_load_destroy(&load);
 }
 
 /*
- * Create event and assign handler
+ * Upload decoded assets of the asynchronous loads, within the frame budget
  */
-int gui_event_create(gui_t* gui, char* name, gui_event_handler_t handler)
+static inline void gui_loads_update(gui_t* gui)
 {
-  if (!gui || !name)
-  {
-    return 1;
-  }
+  uint64_t budget_us = gui->load_budget_us ? gui->load_budget_us : GUI_LOAD_BUDGET_US;
 
-  gui_event_t* event = gui_event_get(gui, name);
+  uint64_t start_us = gui_time_us_get();
 
-  if (event)
+  for (size_t index = 0; index < gui->load_count;)
   {
-    gui_event_handler_t* temp_handlers = realloc(event->handlers, sizeof(gui_event_handler_t) * (event->handler_count + 1));
-
-    if (!temp_handlers)
-    {
-      return 2;
-    }
-
-    event->handlers = temp_handlers;
+    uint64_t spent_us = gui_time_us_get() - start_us;
 
-    event->handlers[event->handler_count++] = handler;
-  }
-  else
-  {
-    event = _gui_event_create(name, handler);
+    if (spent_us >= budget_us) break;
 
-    if (!event)
-    {
-      return 3;
-    }
+    gui_load_t* load = gui->loads[index];
 
-    gui_event_t** temp_events = realloc(gui->events, sizeof(gui_event_t*) * (gui->event_count + 1));
+    gui_load_upload(gui, load, budget_us - spent_us);
 
-    if (!temp_events)
+    if (load->upload_count == load->job_count)
     {
-      free(event);
-
-      return 4;
+      gui_load_finish(gui, index);
     }
-
-    gui->events = temp_events;
-
-    gui->events[gui->event_count++] = event;
+    else index++;
   }
-
-  return 0;
 }
 
 /*
- * Check if x and y is inside SDL Rect
+ * Check if asynchronous load is done
  */
-static inline bool x_and_y_is_inside_rect(int x, int y, SDL_Rect rect)
+bool gui_load_is_done(gui_t* gui, gui_ticket_t ticket)
 {
-  return (x >= rect.x && x <= (rect.x + rect.w) &&
-          y >= rect.y && y <= (rect.y + rect.h));
+  if (!gui) return true;
+
+  return gui_load_index_get(gui, ticket) == -1;
 }
 
 /*
- * Try to get the window child which x and y is pointing at
+ * Get progress of asynchronous load, from 0 to 1
  */
-static inline gui_window_t* gui_window_x_and_y_child_get(gui_window_t* window, int x, int y)
+float gui_load_progress_get(gui_t* gui, gui_ticket_t ticket)
 {
-  for (size_t index = window->child_count; index-- > 0;)
-  {
-    gui_window_t* child = window->children[index];
+  if (!gui) return 1.0f;
 
-    if (x_and_y_is_inside_rect(x, y, child->sdl_rect))
-    {
-      int child_x = x - child->sdl_rect.x;
-      int child_y = y - child->sdl_rect.y;
+  ssize_t index = gui_load_index_get(gui, ticket);
 
-      gui_window_t* grandchild = gui_window_x_and_y_child_get(child, child_x, child_y);
+  if (index == -1) return 1.0f;
 
-      return grandchild ? grandchild : child;
-    }
-  }
+  gui_load_t* load = gui->loads[index];
 
-  return NULL;
+  // An empty load has nothing left to upload
+  if (load->job_count == 0) return 1.0f;
+
+  return (float) load->upload_count / (float) load->job_count;
 }
 
 /*
- * Try to get the window which x and y is pointing at
+ * Block until asynchronous load is done
  */
-gui_window_t* gui_x_and_y_window_get(gui_t* gui, int x, int y)
+int gui_load_wait(gui_t* gui, gui_ticket_t ticket)
 {
-  gui_menu_t* menu = gui_active_menu_get(gui);
-
-  if (!menu)
+  if (!gui)
   {
-    return NULL;
+    return 1;
   }
 
-  for (size_t index = menu->window_count; index-- > 0;)
+  ssize_t index = gui_load_index_get(gui, ticket);
+
+  if (index == -1)
   {
-    gui_window_t* window = menu->windows[index];
+    return 0;
+  }
 
-    if (x_and_y_is_inside_rect(x, y, window->sdl_rect))
-    {
-      int window_x = x - window->sdl_rect.x;
-      int window_y = y - window->sdl_rect.y;
+  gui_load_t* load = gui->loads[index];
 
-      gui_window_t* child = gui_window_x_and_y_child_get(window, window_x, window_y);
+  while (load->upload_count < load->job_count)
+  {
+    SDL_SemWait(load->done_sem);
 
-      return child ? child : window;
-    }
+    gui_load_upload(gui, load, UINT64_MAX);
   }
 
-  return NULL;
+  int status = (load->fail_count > 0) ? 2 : 0;
+
+  gui_load_finish(gui, index);
+
+  return status;
 }
 
 /*
- *
+ * Destroy all asynchronous loads, without finishing them
  */
-static inline void gui_event_handler_call(gui_t* gui, SDL_Event* event, gui_window_t* window, gui_event_handler_t handler)
+static inline void gui_loads_destroy(gui_t* gui)
 {
-  int x = event->button.x;
-  int y = event->button.y;
-
-  int key = event->key.keysym.sym;
-
-  int width  = event->window.data1;
-  int height = event->window.data2;
-
-  switch (handler.type)
+  for (size_t index = 0; index < gui->load_count; index++)
   {
-    case GUI_EVENT_HANDLER_GUI:
-      if (handler.handler.gui)
-      {
-        handler.handler.gui(gui);
-      }
-      break;
+    gui_load_destroy(&gui->loads[index]);
+  }
 
-    case GUI_EVENT_HANDLER_KEY:
-      if (handler.handler.key)
-      {
-        handler.handler.key(gui, key);
-      }
-      break;
+  free(gui->loads);
 
-    case GUI_EVENT_HANDLER_MOUSE:
-      if (handler.handler.mouse)
-      {
-        handler.handler.mouse(gui, x, y);
-      }
-      break;
+  gui->loads = NULL;
 
-    case GUI_EVENT_HANDLER_RESIZE:
-      if (handler.handler.resize)
-      {
-        handler.handler.resize(gui, width, height);
-      }
-      break;
+  gui->load_count = 0;
+}
 
-    case GUI_EVENT_HANDLER_WINDOW:
-      if (handler.handler.window)
-      {
-        handler.handler.window(gui, window);
-      }
-      break;
+/*
+ * Memory budget
+ */
 
-    default:
-      break;
-  }
-}
+/*
+ * Texture, text entry or menu target, that can be released and created again
+ */
+typedef struct gui_evictable_t
+{
+  gui_texture_t*    texture;
+  gui_text_entry_t* entry;
+  gui_menu_t*       menu;
+  uint64_t          used_frame;
+  size_t            bytes;
+} gui_evictable_t;
 
 /*
- * Trigger event by calling handlers of type GUI_EVENT_HANDLER_GUI,
- * which does not require any input data
+ * Get texture memory in use
  */
-void gui_user_event_trigger(gui_t* gui, char* name)
+gui_memory_t gui_memory_get(gui_t* gui)
 {
-  gui_event_t* gui_event = gui_event_get(gui, name);
+  if (!gui) return (gui_memory_t) { 0 };
 
-  if (!gui_event) return;
+  gui_assets_t* assets = gui->assets;
 
-  for (size_t index = 0; index < gui_event->handler_count; index++)
+  gui_memory_t memory =
   {
-    gui_event_handler_t handler = gui_event->handlers[index];
+    .texture_bytes = assets->texture_bytes,
+    .atlas_bytes   = (size_t) assets->page_count * GUI_TEXTURE_ATLAS_SIZE * GUI_TEXTURE_ATLAS_SIZE * 4,
+    .text_bytes    = gui->text_cache.bytes,
+    .target_bytes  = gui->target_bytes,
+    .budget_bytes  = gui->memory_budget
+  };
 
-    if (handler.type == GUI_EVENT_HANDLER_GUI)
+  for (size_t index = 0; index < assets->font_count; index++)
+  {
+    gui_glyph_atlas_t* atlas = assets->fonts[index]->atlas;
+
+    if (atlas)
     {
-      if (handler.handler.gui)
-      {
-        handler.handler.gui(gui);
-      }
+      memory.atlas_bytes += (size_t) atlas->width * atlas->height * 4;
     }
   }
-}
 
-/*
- *
- */
-static inline void gui_event_handlers_call(gui_t* gui, SDL_Event* event, gui_window_t* window, gui_event_t* gui_event)
-{
-  for (size_t index = 0; index < gui_event->handler_count; index++)
-  {
-    gui_event_handler_t handler = gui_event->handlers[index];
+  memory.total_bytes = memory.texture_bytes + memory.atlas_bytes + memory.text_bytes + memory.target_bytes;
 
-    gui_event_handler_call(gui, event, window, handler);
-  }
+  return memory;
 }
 
 /*
- *
+ * Compare evictables, the least recently used first
  */
-static inline void gui_event_trigger(gui_t* gui, SDL_Event* event, gui_window_t* window, char* name)
+static int gui_evictable_compare(const void* first, const void* second)
 {
-  gui_event_t* gui_event = gui_event_get(gui, name);
-
-  if (!gui_event) return;
+  uint64_t first_frame  = ((const gui_evictable_t*) first)->used_frame;
+  uint64_t second_frame = ((const gui_evictable_t*) second)->used_frame;
 
-  gui_event_handlers_call(gui, event, window, gui_event);
+  return (first_frame > second_frame) - (first_frame < second_frame);
 }
 
 /*
+ * Get everything that can be released, if it is not in use
  *
+ * Registered textures can be loaded again, and menu targets can be
+ * composited again if nothing has been drawn directly on them
  */
-static inline void gui_mouse_up_event_handle(gui_t* gui, SDL_Event* event)
+static inline size_t gui_evictables_get(gui_t* gui, gui_evictable_t* evictables)
 {
-  int x = event->button.x;
-  int y = event->button.y;
-
-  gui_window_t* window = gui_x_and_y_window_get(gui, x, y);
-
-  switch (event->button.button)
-  {
-    case SDL_BUTTON_LEFT:
-      gui_event_trigger(gui, event, window, "mouse-up-left");
-      break;
-
-    case SDL_BUTTON_RIGHT:
-      gui_event_trigger(gui, event, window, "mouse-up-right");
-      break;
-
-    default:
-      break;
-  }
-}
+  gui_assets_t* assets = gui->assets;
 
-/*
- *
- */
-static inline void gui_mouse_down_event_handle(gui_t* gui, SDL_Event* event)
-{
-  int x = event->button.x;
-  int y = event->button.y;
+  gui_menu_t* active_menu = gui_menu_get(gui, gui->menu_name);
 
-  gui_window_t* window = gui_x_and_y_window_get(gui, x, y);
+  size_t count = 0;
 
-  switch (event->button.button)
+  for (size_t index = 0; index < assets->texture_count; index++)
   {
-    case SDL_BUTTON_LEFT:
-      gui_event_trigger(gui, event, window, "mouse-down-left");
-      break;
+    gui_texture_t* texture = assets->textures[index];
 
-    case SDL_BUTTON_RIGHT:
-      gui_event_trigger(gui, event, window, "mouse-down-right");
-      break;
+    if (texture->texture && texture->filepath && !texture->page)
+    {
+      evictables[count++] = (gui_evictable_t) { .texture = texture, .used_frame = texture->used_frame, .bytes = texture->bytes };
+    }
+  }
 
-    default:
-      break;
+  for (gui_text_entry_t* entry = gui->text_cache.oldest; entry; entry = entry->newer)
+  {
+    evictables[count++] = (gui_evictable_t) { .entry = entry, .used_frame = entry->used_frame, .bytes = entry->bytes };
+  }
+
+  for (size_t index = 0; index < gui->menu_count; index++)
+  {
+    gui_menu_t* menu = gui->menus[index];
+
+    if (menu != active_menu && menu->texture && !menu->has_drawing)
+    {
+      evictables[count++] = (gui_evictable_t) { .menu = menu, .used_frame = menu->used_frame, .bytes = sdl_texture_bytes_get(menu->texture) };
+    }
   }
+
+  return count;
 }
 
 /*
- * Handle window event
+ * Release evictable texture
  */
-static inline void gui_window_event_handle(gui_t* gui, SDL_Event* event)
+static inline void gui_evictable_release(gui_t* gui, gui_evictable_t* evictable)
 {
-  switch (event->window.event)
+  if (evictable->texture)
   {
-    case SDL_WINDOWEVENT_RESIZED: case SDL_WINDOWEVENT_SIZE_CHANGED:
-      gui_event_trigger(gui, event, NULL, "resize");
-      break;
+    gui->assets->texture_bytes -= evictable->texture->bytes;
 
-    default:
-      break;
+    evictable->texture->bytes = 0;
+
+    sdl_texture_destroy(&evictable->texture->texture);
+  }
+  else if (evictable->entry)
+  {
+    gui_text_cache_entry_remove(&gui->text_cache, evictable->entry);
   }
+  else if (evictable->menu)
+  {
+    // A pooled texture would still use the memory
+    gui_target_texture_free(gui, &evictable->menu->texture);
+  }
+
+  gui->stats.evicted_count++;
 }
 
 /*
+ * Release the least recently used textures, until the memory is within budget
  *
+ * Only what wasn't used in the current frame is released
  */
-static inline void gui_mouse_motion_event_handle(gui_t* gui, SDL_Event* event)
+static inline void gui_memory_trim(gui_t* gui)
 {
-  int x = event->button.x;
-  int y = event->button.y;
+  if (gui->memory_budget == 0) return;
 
-  gui_window_t* window = gui_x_and_y_window_get(gui, x, y);
+  if (gui_memory_get(gui).total_bytes <= gui->memory_budget) return;
 
-  gui_event_trigger(gui, event, window, "mouse-motion");
+  // The pooled render targets are released first, as they are unused
+  gui_target_pool_free(gui);
 
+  size_t total_bytes = gui_memory_get(gui).total_bytes;
 
-  if (window != gui->curr_window)
-  {
-    if (gui->curr_window)
-    {
-      printf("window exit: %s\n", gui->curr_window->name);
+  if (total_bytes <= gui->memory_budget) return;
 
-      gui->last_window = gui->curr_window;
+  size_t max_count = gui->assets->texture_count + gui->text_cache.entry_count + gui->menu_count;
 
-      gui->curr_window = NULL;
+  gui_evictable_t* evictables = malloc(sizeof(gui_evictable_t) * MAX(max_count, 1));
 
-      gui_event_trigger(gui, event, gui->last_window, "window-exit");
-    }
+  if (!evictables) return;
 
-    if (window)
-    {
-      printf("window enter: %s\n", window->name);
+  size_t count = gui_evictables_get(gui, evictables);
 
-      gui->last_window = gui->curr_window;
+  qsort(evictables, count, sizeof(gui_evictable_t), gui_evictable_compare);
 
-      gui->curr_window = window;
+  for (size_t index = 0; index < count && total_bytes > gui->memory_budget; index++)
+  {
+    if (evictables[index].used_frame >= gui->frame_index) break;
 
-      gui_event_trigger(gui, event, gui->curr_window, "window-enter");
-    }
+    gui_evictable_release(gui, &evictables[index]);
+
+    total_bytes = gui_memory_get(gui).total_bytes;
   }
+
+  free(evictables);
 }
 
 /*
- * Handle event
+ * Set texture memory budget in bytes, 0 for no budget
+ *
+ * Textures are released at the end of gui_render, when it is exceeded
  */
-static inline void gui_event_handle(gui_t* gui, SDL_Event* event)
+int gui_memory_budget_set(gui_t* gui, size_t bytes)
 {
-  if (!event) return;
-
-  switch (event->type)
+  if (!gui)
   {
-    case SDL_QUIT:
-      gui_event_trigger(gui, event, NULL, "quit");
-      break;
-
-    case SDL_WINDOWEVENT:
-      gui_window_event_handle(gui, event);
-      break;
-
-    case SDL_MOUSEBUTTONDOWN:
-      gui_mouse_down_event_handle(gui, event);
-      break;
-
-    case SDL_MOUSEBUTTONUP:
-      gui_mouse_up_event_handle(gui, event);
-      break;
-
-    case SDL_KEYDOWN:
-      gui_event_trigger(gui, event, NULL, "key-down");
-      break;
+    return 1;
+  }
 
-    case SDL_KEYUP:
-      gui_event_trigger(gui, event, NULL, "key-up");
-      break;
+  gui->memory_budget = bytes;
 
-    case SDL_MOUSEMOTION:
-      gui_mouse_motion_event_handle(gui, event);
-      break;
+  gui_memory_trim(gui);
 
-    default:
-      break;
-  }
+  return 0;
 }
 
 /*
@@ -3113,15 +9219,31 @@ void gui_destroy(gui_t** gui)
   free((*gui)->menus);
 
 
+  gui_text_cache_free(&(*gui)->text_cache);
+
+  gui_sprite_batch_free(&(*gui)->sprite_batch);
+
+  gui_rect_batch_free(&(*gui)->rect_batch);
+
+  gui_target_pool_free(*gui);
+
   gui_assets_destroy(&(*gui)->assets);
 
   gui_events_destroy(&(*gui)->events, (*gui)->event_count);
 
+  free((*gui)->event_index.slots);
+
+  gui_loads_destroy(*gui);
+
+  gui_profile_free(*gui);
+
 
   sdl_renderer_destroy(&(*gui)->renderer);
 
   sdl_window_destroy(&(*gui)->window);
 
+  sdl_surface_destroy(&(*gui)->surface);
+
   free(*gui);
 
   *gui = NULL;
@@ -3155,6 +9277,28 @@ static inline gui_window_t* gui_menu_window_search(gui_menu_t* menu, char** name
   return window;
 }
 
+/*
+ * Get window in menu by path of window names
+ *
+ * Resolve the window once, and render to it with the window functions
+ */
+gui_window_t* gui_window_get(gui_t* gui, char* menu_name, char** window_names)
+{
+  if (!gui || !menu_name || !window_names)
+  {
+    return NULL;
+  }
+
+  gui_menu_t* menu = gui_menu_layout_get(gui, menu_name);
+
+  if (!menu)
+  {
+    return NULL;
+  }
+
+  return gui_menu_window_search(menu, window_names);
+}
+
 /*
  * Render texture on either window texture or menu texture
  */
@@ -3165,7 +9309,7 @@ int gui_texture_render(gui_t* gui, char* menu_name, char** window_names, char* t
     return 1;
   }
 
-  gui_menu_t* menu = gui_menu_get(gui, menu_name);
+  gui_menu_t* menu = gui_menu_layout_get(gui, menu_name);
 
   if (!menu)
   {
@@ -3207,7 +9351,7 @@ int gui_text_render(gui_t* gui, char* menu_name, char** window_names, gui_text_t
     return 1;
   }
 
-  gui_menu_t* menu = gui_menu_get(gui, menu_name);
+  gui_menu_t* menu = gui_menu_layout_get(gui, menu_name);
 
   if (!menu)
   {
@@ -3244,24 +9388,35 @@ int gui_text_render(gui_t* gui, char* menu_name, char** window_names, gui_text_t
  */
 int gui_window_clear(gui_window_t* window)
 {
+  if (!window)
+  {
+    return 1;
+  }
+
   gui_t* gui = window->gui;
 
   if (!gui)
   {
-    return 1;
+    return 2;
   }
 
   SDL_Renderer* renderer = gui->renderer;
 
   if (!renderer)
   {
-    return 2;
+    return 3;
   }
 
-  if (sdl_target_clear(renderer, window->texture) != 0)
+  if (gui_window_draw_list_get(window))
   {
-    return 3;
+    gui_draw_list_free(&window->draw_list);
   }
+  else if (gui_target_clear(gui, window->texture) != 0)
+  {
+    return 4;
+  }
+
+  gui_window_damage_all(window);
 
   for (size_t index = 0; index < window->child_count; index++)
   {
@@ -3269,7 +9424,7 @@ int gui_window_clear(gui_window_t* window)
 
     if (gui_window_clear(child) != 0)
     {
-      return 4;
+      return 5;
     }
   }
 
@@ -3295,11 +9450,19 @@ int gui_menu_clear(gui_menu_t* menu)
     return 2;
   }
 
-  if (sdl_target_clear(renderer, menu->texture) != 0)
+  if (gui_menu_draw_list_get(menu))
+  {
+    gui_draw_list_free(&menu->draw_list);
+  }
+  else if (!gui_menu_target_get(menu) || gui_target_clear(gui, menu->texture) != 0)
   {
     return 3;
   }
 
+  menu->has_drawing = false;
+
+  gui_menu_damage(menu, (SDL_Rect) { 0, 0, gui->width, gui->height });
+
   for (size_t index = 0; index < menu->window_count; index++)
   {
     gui_window_t* window = menu->windows[index];
@@ -3330,7 +9493,7 @@ int gui_clear(gui_t* gui)
     return 2;
   }
 
-  if (sdl_target_clear(renderer, NULL) != 0)
+  if (gui_target_clear(gui, NULL) != 0)
   {
     return 3;
   }
@@ -3347,6 +9510,9 @@ int gui_clear(gui_t* gui)
 
 /*
  * Render screen
+ *
+ * If nothing has changed since the last frame, nothing is rendered
+ * and the screen is not presented again
  */
 int gui_render(gui_t* gui)
 {
@@ -3364,22 +9530,163 @@ int gui_render(gui_t* gui)
 
   gui_menu_t* menu = gui_active_menu_get(gui);
 
-  if (gui_menu_render(menu) != 0)
+  if (!menu)
   {
-    return 4;
+    return 3;
   }
 
-  // Render the menu texture to the screen
-  if (sdl_target_texture_render(renderer, NULL, menu->texture, NULL) != 0)
+  gui->stats.frame_count++;
+
+  gui->frame_index++;
+
+  menu->used_frame = gui->frame_index;
+
+  if (menu != gui->render_menu)
   {
-    return 5;
+    menu->is_dirty = true;
+
+    gui->render_menu = menu;
+  }
+
+  if (!menu->is_dirty)
+  {
+    gui->stats.idle_frame_count++;
+
+    return 0;
+  }
+
+  GUI_PROFILE_BEGIN(render_us);
+
+  if (gui->composite == GUI_COMPOSITE_DIRECT)
+  {
+    if (gui_menu_direct_render(menu) != 0)
+    {
+      return 4;
+    }
+
+    GUI_PROFILE_END(gui, render_us, "gui_menu_direct_render", "render");
+  }
+  else
+  {
+    if (gui_menu_render(menu) != 0)
+    {
+      return 4;
+    }
+
+    GUI_PROFILE_END(gui, render_us, "gui_menu_render", "render");
+
+    // Render the whole menu texture to the screen,
+    // because the back buffer is undefined after it has been presented
+    if (gui_target_part_render(gui, NULL, menu->texture, gui->width, gui->height, NULL) != 0)
+    {
+      return 5;
+    }
   }
 
+  GUI_PROFILE_BEGIN(present_us);
+
   SDL_RenderPresent(renderer);
 
+  GUI_PROFILE_END(gui, present_us, "SDL_RenderPresent", "render");
+
+  gui->stats.present_count++;
+
+  menu->is_dirty = false;
+
+  gui_memory_trim(gui);
+
   return 0;
 }
 
+/*
+ * Get counters of the work done by the renderer
+ */
+gui_stats_t gui_stats_get(gui_t* gui)
+{
+  if (!gui) return (gui_stats_t) { 0 };
+
+  return gui->stats;
+}
+
+/*
+ * Reset counters of the work done by the renderer
+ */
+void gui_stats_reset(gui_t* gui)
+{
+  if (!gui) return;
+
+  gui->stats = (gui_stats_t) { 0 };
+}
+
+/*
+ * Get the percentage of time gui_start has been idle, waiting for events
+ */
+float gui_idle_percent_get(gui_t* gui)
+{
+  if (!gui || gui->stats.loop_us == 0) return 0.0f;
+
+  return 100.0f * (float) gui->stats.wait_us / (float) gui->stats.loop_us;
+}
+
+/*
+ * Start an animation, which makes gui_start trigger the frame event
+ * and render every frame, until the animation is stopped
+ *
+ * Asynchronous loads also keep gui_start rendering every frame
+ */
+void gui_animation_start(gui_t* gui)
+{
+  if (!gui) return;
+
+  gui->animation_count++;
+}
+
+/*
+ * Stop an animation started by gui_animation_start
+ */
+void gui_animation_stop(gui_t* gui)
+{
+  if (!gui || gui->animation_count == 0) return;
+
+  gui->animation_count--;
+}
+
+/*
+ * Check if the next frame has anything to render
+ */
+static inline bool gui_render_is_pending(gui_t* gui)
+{
+  if (gui->animation_count > 0 || gui->load_count > 0)
+  {
+    return true;
+  }
+
+  gui_menu_t* menu = gui_active_menu_get(gui);
+
+  if (!menu)
+  {
+    return false;
+  }
+
+  return menu != gui->render_menu || menu->is_dirty;
+}
+
+/*
+ * Wait for an event, at most timeout milliseconds, or forever if timeout is -1
+ *
+ * The time spent waiting is counted as idle time
+ */
+static inline int gui_event_wait(gui_t* gui, SDL_Event* event, int timeout)
+{
+  uint64_t start_us = gui_time_us_get();
+
+  int status = (timeout == -1) ? SDL_WaitEvent(event) : SDL_WaitEventTimeout(event, timeout);
+
+  gui->stats.wait_us += gui_time_us_get() - start_us;
+
+  return status;
+}
+
 /*
  * Stop gui, don't render any more frames or handle events
  */
@@ -3399,27 +9706,76 @@ void gui_start(gui_t* gui, int fps)
 
   gui->is_running = true;
 
-  Uint32 end_ticks   = 0;
-  Uint32 start_ticks = 0;
+  Uint32 frame_ticks = 1000 / fps;
+
+  Uint32 render_ticks = SDL_GetTicks() - frame_ticks;
+
+  uint64_t loop_us = gui_time_us_get();
 
   SDL_Event event;
   SDL_memset(&event, 0, sizeof(event));
 
   while (gui->is_running)
   {
-    while (SDL_PollEvent(&event))
+    // Sleep until the next event, or until the next frame is due
+    int timeout = -1;
+
+    if (gui_render_is_pending(gui))
+    {
+      Uint32 elapsed_ticks = SDL_GetTicks() - render_ticks;
+
+      timeout = (elapsed_ticks >= frame_ticks) ? 0 : (frame_ticks - elapsed_ticks);
+    }
+
+    // Wake up when the window size has been stable long enough
+    int resize_timeout = gui_resize_timeout_get(gui);
+
+    if (resize_timeout != -1 && (timeout == -1 || resize_timeout < timeout))
+    {
+      timeout = resize_timeout;
+    }
+
+    if (timeout != 0 && gui_event_wait(gui, &event, timeout))
+    {
+      gui_event_handle(gui, &event);
+    }
+
+    while (gui->is_running && SDL_PollEvent(&event))
     {
       gui_event_handle(gui, &event);
     }
 
-    end_ticks = SDL_GetTicks();
+    gui_motion_flush(gui);
+
+    gui_resize_flush(gui);
 
-    if (end_ticks - start_ticks >= 1000 / fps)
+    Uint32 ticks = SDL_GetTicks();
+
+    if (gui->is_running && ticks - render_ticks >= frame_ticks)
     {
-      gui_render(gui);
+      if (gui->load_count > 0)
+      {
+        gui_loads_update(gui);
+      }
+
+      if (gui->animation_count > 0)
+      {
+        gui_user_event_id_trigger(gui, GUI_EVENT_FRAME);
+      }
+
+      if (gui_render_is_pending(gui))
+      {
+        gui_render(gui);
 
-      start_ticks = end_ticks;
+        render_ticks = ticks;
+      }
     }
+
+    uint64_t now_us = gui_time_us_get();
+
+    gui->stats.loop_us += now_us - loop_us;
+
+    loop_us = now_us;
   }
 }
 
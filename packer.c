@@ -0,0 +1,335 @@
+/*
+ * Packer of assets into a bundle, that gui_bundle_load maps into memory
+ *
+ * Usage: ./packer <bundle> <kind>:<name>=<path> ...
+ *
+ * kind is texture, font or chunk. Textures are stored as decoded RGBA
+ * pixels and chunks as PCM in the audio format of the mixer
+ */
+
+#define GUI_IMPLEMENT
+#include "gui.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+
+#define BUNDLE_ALIGN 16
+
+/*
+ * Decoded asset, ready to be written to the bundle
+ */
+typedef struct packed_t
+{
+  gui_bundle_entry_t entry;
+  SDL_Surface*       surface;
+  void*              data;
+  Mix_Chunk*         chunk;
+} packed_t;
+
+/*
+ * Get the number of padding bytes, to align offset
+ */
+static size_t padding_get(size_t offset)
+{
+  return (BUNDLE_ALIGN - (offset % BUNDLE_ALIGN)) % BUNDLE_ALIGN;
+}
+
+/*
+ * Decode texture into RGBA pixels
+ */
+static int texture_pack(packed_t* packed, const char* path)
+{
+  SDL_Surface* surface = IMG_Load(path);
+
+  if (!surface)
+  {
+    fprintf(stderr, "IMG_Load: %s\n", IMG_GetError());
+
+    return 1;
+  }
+
+  packed->surface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+
+  SDL_FreeSurface(surface);
+
+  if (!packed->surface)
+  {
+    fprintf(stderr, "SDL_ConvertSurfaceFormat: %s\n", SDL_GetError());
+
+    return 2;
+  }
+
+  packed->entry.kind   = GUI_ASSET_TEXTURE;
+  packed->entry.width  = packed->surface->w;
+  packed->entry.height = packed->surface->h;
+  packed->entry.format = SDL_PIXELFORMAT_RGBA32;
+  packed->entry.size   = (uint64_t) packed->surface->w * packed->surface->h * 4;
+
+  return 0;
+}
+
+/*
+ * Read font file as is, because the font is opened at load time
+ */
+static int font_pack(packed_t* packed, const char* path)
+{
+  size_t size = 0;
+
+  packed->data = SDL_LoadFile(path, &size);
+
+  if (!packed->data)
+  {
+    fprintf(stderr, "SDL_LoadFile: %s\n", SDL_GetError());
+
+    return 1;
+  }
+
+  packed->entry.kind = GUI_ASSET_FONT;
+  packed->entry.size = size;
+
+  return 0;
+}
+
+/*
+ * Decode chunk into PCM, in the audio format of the mixer
+ */
+static int chunk_pack(packed_t* packed, const char* path)
+{
+  int    frequency;
+  Uint16 format;
+  int    channels;
+
+  if (Mix_QuerySpec(&frequency, &format, &channels) == 0)
+  {
+    fprintf(stderr, "Mix_QuerySpec: %s\n", Mix_GetError());
+
+    return 1;
+  }
+
+  packed->chunk = Mix_LoadWAV(path);
+
+  if (!packed->chunk)
+  {
+    fprintf(stderr, "Mix_LoadWAV: %s\n", Mix_GetError());
+
+    return 2;
+  }
+
+  packed->entry.kind   = GUI_ASSET_CHUNK;
+  packed->entry.width  = frequency;
+  packed->entry.height = channels;
+  packed->entry.format = format;
+  packed->entry.size   = packed->chunk->alen;
+
+  return 0;
+}
+
+/*
+ * Parse argument of the form kind:name=path, and decode the asset
+ */
+static int asset_pack(packed_t* packed, char* arg)
+{
+  char* name = strchr(arg, ':');
+
+  char* path = name ? strchr(name, '=') : NULL;
+
+  if (!name || !path)
+  {
+    fprintf(stderr, "Bad asset: %s\n", arg);
+
+    return 1;
+  }
+
+  *name++ = '\0';
+  *path++ = '\0';
+
+  if (strlen(name) >= sizeof(packed->entry.name))
+  {
+    fprintf(stderr, "Too long name: %s\n", name);
+
+    return 2;
+  }
+
+  strcpy(packed->entry.name, name);
+
+  if (strcmp(arg, "texture") == 0)
+  {
+    return texture_pack(packed, path);
+  }
+  else if (strcmp(arg, "font") == 0)
+  {
+    return font_pack(packed, path);
+  }
+  else if (strcmp(arg, "chunk") == 0)
+  {
+    return chunk_pack(packed, path);
+  }
+
+  fprintf(stderr, "Bad kind: %s\n", arg);
+
+  return 3;
+}
+
+/*
+ * Write the data of packed asset
+ */
+static int packed_write(FILE* file, packed_t* packed)
+{
+  if (packed->surface)
+  {
+    SDL_Surface* surface = packed->surface;
+
+    // The rows of the surface can be padded
+    for (int y = 0; y < surface->h; y++)
+    {
+      if (fwrite((char*) surface->pixels + y * surface->pitch, 4, surface->w, file) != (size_t) surface->w)
+      {
+        return 1;
+      }
+    }
+
+    return 0;
+  }
+
+  void* data = packed->chunk ? (void*) packed->chunk->abuf : packed->data;
+
+  if (fwrite(data, 1, packed->entry.size, file) != packed->entry.size)
+  {
+    return 2;
+  }
+
+  return 0;
+}
+
+/*
+ * Write header, entries and data of assets to bundle file
+ */
+static int bundle_write(const char* filepath, packed_t* packeds, size_t count)
+{
+  FILE* file = fopen(filepath, "wb");
+
+  if (!file)
+  {
+    fprintf(stderr, "fopen: %s: %s\n", filepath, strerror(errno));
+
+    return 1;
+  }
+
+  gui_bundle_header_t header = { .version = GUI_BUNDLE_VERSION, .entry_count = count };
+
+  memcpy(header.magic, GUI_BUNDLE_MAGIC, 4);
+
+  size_t offset = sizeof(gui_bundle_header_t) + sizeof(gui_bundle_entry_t) * count;
+
+  for (size_t index = 0; index < count; index++)
+  {
+    offset += padding_get(offset);
+
+    packeds[index].entry.offset = offset;
+
+    offset += packeds[index].entry.size;
+  }
+
+  int status = 0;
+
+  if (fwrite(&header, sizeof(header), 1, file) != 1)
+  {
+    status = 2;
+  }
+
+  for (size_t index = 0; !status && index < count; index++)
+  {
+    if (fwrite(&packeds[index].entry, sizeof(gui_bundle_entry_t), 1, file) != 1)
+    {
+      status = 3;
+    }
+  }
+
+  static const char zeros[BUNDLE_ALIGN] = { 0 };
+
+  for (size_t index = 0; !status && index < count; index++)
+  {
+    size_t padding = padding_get(ftell(file));
+
+    if (fwrite(zeros, 1, padding, file) != padding || packed_write(file, &packeds[index]) != 0)
+    {
+      status = 4;
+    }
+  }
+
+  if (fclose(file) != 0 && !status)
+  {
+    status = 5;
+  }
+
+  if (status)
+  {
+    fprintf(stderr, "Failed to write bundle: %s\n", filepath);
+  }
+
+  return status;
+}
+
+/*
+ * Main function
+ */
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    fprintf(stderr, "Usage: %s <bundle> <kind>:<name>=<path> ...\n", argv[0]);
+
+    return 1;
+  }
+
+  // No window or sound is needed, only the audio format of the mixer
+  setenv("SDL_VIDEODRIVER", "dummy", 0);
+  setenv("SDL_AUDIODRIVER", "dummy", 0);
+
+  if (gui_init() != 0)
+  {
+    fprintf(stderr, "gui_init: %s", strerror(errno));
+
+    return 2;
+  }
+
+  size_t count = argc - 2;
+
+  packed_t* packeds = calloc(count + 1, sizeof(packed_t));
+
+  int status = packeds ? 0 : 3;
+
+  for (size_t index = 0; !status && index < count; index++)
+  {
+    if (asset_pack(&packeds[index], argv[index + 2]) != 0)
+    {
+      status = 4;
+    }
+  }
+
+  if (!status && bundle_write(argv[1], packeds, count) != 0)
+  {
+    status = 5;
+  }
+
+  for (size_t index = 0; packeds && index < count; index++)
+  {
+    SDL_FreeSurface(packeds[index].surface);
+
+    SDL_free(packeds[index].data);
+
+    if (packeds[index].chunk)
+    {
+      Mix_FreeChunk(packeds[index].chunk);
+    }
+  }
+
+  free(packeds);
+
+  gui_quit();
+
+  return status;
+}
@@ -12,45 +12,11 @@
 #include <string.h>
 
 /*
- *
+ * Render the second button, which changes when it is hovered
  */
-void game_render(gui_t* gui)
+void second_button_render(gui_t* gui)
 {
-  gui_clear(gui);
-
-  gui_texture_render(gui, "first", (char*[]) { NULL }, "symbol-one",
-    (gui_rect_t) {
-      .height = (gui_size_t)
-      {
-        .type = GUI_SIZE_MAX
-      },
-      .aspect_ratio = 1 / 1
-    }
-  );
-
-  gui_texture_render(gui, "first", (char*[]) { "parent", NULL }, "background-field",
-    (gui_rect_t) {
-      .height = (gui_size_t)
-      {
-        .type = GUI_SIZE_MAX
-      },
-      .width = (gui_size_t)
-      {
-        .type = GUI_SIZE_MAX
-      }
-    }
-  );
-
-  gui_texture_render(gui, "first", (char*[]) { "parent", NULL }, "symbol-two",
-    (gui_rect_t) {
-      .height = (gui_size_t)
-      {
-        .type = GUI_SIZE_MAX
-      },
-      .xpos = GUI_POS_RIGHT,
-      .aspect_ratio = 1 / 1
-    }
-  );
+  gui_window_clear(gui_window_get(gui, "first", (char*[]) { "second-button", NULL }));
 
   gui_texture_render(gui, "first", (char*[]) { "second-button", NULL }, "square-exploded",
     (gui_rect_t) {
@@ -100,6 +66,50 @@ void game_render(gui_t* gui)
       }
     );
   }
+}
+
+/*
+ *
+ */
+void game_render(gui_t* gui)
+{
+  gui_clear(gui);
+
+  gui_texture_render(gui, "first", (char*[]) { NULL }, "symbol-one",
+    (gui_rect_t) {
+      .height = (gui_size_t)
+      {
+        .type = GUI_SIZE_MAX
+      },
+      .aspect_ratio = 1 / 1
+    }
+  );
+
+  gui_texture_render(gui, "first", (char*[]) { "parent", NULL }, "background-field",
+    (gui_rect_t) {
+      .height = (gui_size_t)
+      {
+        .type = GUI_SIZE_MAX
+      },
+      .width = (gui_size_t)
+      {
+        .type = GUI_SIZE_MAX
+      }
+    }
+  );
+
+  gui_texture_render(gui, "first", (char*[]) { "parent", NULL }, "symbol-two",
+    (gui_rect_t) {
+      .height = (gui_size_t)
+      {
+        .type = GUI_SIZE_MAX
+      },
+      .xpos = GUI_POS_RIGHT,
+      .aspect_ratio = 1 / 1
+    }
+  );
+
+  second_button_render(gui);
 
   gui_text_render(gui, "second", (char*[]) { "first-button", NULL },
     (gui_text_t) {
@@ -220,7 +230,23 @@ void* key_down_handle(gui_t* gui, int key)
  */
 void* window_enter_event_handle(gui_t* gui, gui_window_t* window)
 {
-  game_render(gui);
+  // Only the hovered button and its border have to be rendered again
+  if (gui_window_name_check(window, "second-button"))
+  {
+    second_button_render(gui);
+
+    gui_curr_window_border_render(gui, (gui_border_t) {
+      .thickness = 10,
+      .opacity = 255,
+      .color = (gui_color_t) { 255, 0, 255 }
+    });
+  }
+  else
+  {
+    game_render(gui);
+  }
+
+  return NULL;
 }
 
 /*
@@ -229,6 +255,8 @@ void* window_enter_event_handle(gui_t* gui, gui_window_t* window)
 void* window_exit_event_handle(gui_t* gui, gui_window_t* window)
 {
   game_render(gui);
+
+  return NULL;
 }
 
 /*
@@ -277,6 +305,24 @@ void gui_events_create(gui_t* gui)
  */
 void gui_assets_load(gui_t* gui)
 {
+  // The packed bundle is preferred, as it is mapped without decoding
+  int status = gui_bundle_load(gui, "assets.bundle");
+
+  if (status == 0)
+  {
+    printf("Loaded bundle\n");
+
+    return;
+  }
+
+  // Some assets are already registered from the bundle
+  if (status == 5)
+  {
+    printf("Loaded bundle partly\n");
+
+    return;
+  }
+
   gui_asset_t textures[] = {
     { "symbol-one", "../minesweeper/assets/textures/symbol-one.png" },
     { "symbol-two", "../minesweeper/assets/textures/symbol-two.png" },
@@ -286,9 +332,10 @@ void gui_assets_load(gui_t* gui)
 
   size_t texture_count = sizeof(textures) / sizeof(gui_asset_t);
 
-  if (gui_textures_load(gui, textures, texture_count) == 0)
+  // The textures are loaded when they are first needed
+  if (gui_textures_register(gui, textures, texture_count) == 0)
   {
-    printf("Loaded textures\n");
+    printf("Registered textures\n");
   }
 
 
@@ -326,7 +373,7 @@ void gui_menu_first_setup(gui_t* gui)
 {
   gui_menu_t* menu = gui_menu_create(gui, "first");
 
-  gui_menu_window_create(menu, "parent",
+  gui_window_t* parent = gui_menu_window_create(menu, "parent",
     (gui_rect_t) {
       .width = (gui_size_t) {
         .type = GUI_SIZE_REL,
@@ -348,6 +395,9 @@ void gui_menu_first_setup(gui_t* gui)
     }
   );
 
+  // The background field fills the whole parent window
+  gui_window_opaque_set(parent, true);
+
   gui_menu_window_create(menu, "second-button",
     (gui_rect_t) {
       .width = (gui_size_t) {
@@ -442,6 +492,10 @@ void gui_setup(gui_t* gui)
 
   gui_assets_load(gui);
 
+  gui_menu_preload_set(gui, "first", (char*[]) {
+    "symbol-one", "symbol-two", "square-exploded", "background-field", NULL
+  });
+
   gui_events_create(gui);
 }
 
@@ -463,12 +517,16 @@ int main(int argc, char* argv[])
   {
     gui_setup(gui);
 
+    gui_motion_coalesce_set(gui, true);
+
     gui_active_menu_set(gui, "first");
 
     game_render(gui);
 
     gui_start(gui, 60);
 
+    printf("idle: %.1f%%\n", gui_idle_percent_get(gui));
+
     gui_destroy(&gui);
   }
 